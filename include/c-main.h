@@ -111,6 +111,7 @@ void MLton_threadFunc (void* arg) {                                     \
                                                                         \
   PUBLIC int MLton_main (int argc, char* argv[]) {                      \
     int procNo;                                                         \
+    int numStates;                                                      \
     GC_state gcState;                                                   \
     pthread_t *threads;                                                 \
     {                                                                   \
@@ -118,7 +119,9 @@ void MLton_threadFunc (void* arg) {                                     \
       /* Initialize with a generic state to read in @MLtons, etc */     \
       Initialize ((&s), al, mg, mfs, mmc, pk, ps);                      \
                                                                         \
-      gcState = (GC_state) malloc (s.numberOfProcs * sizeof (struct GC_state)); \
+      /* processors, then dedicated gc threads */                       \
+      numStates = s.numberOfProcs + s.controls->gcThreads;              \
+      gcState = (GC_state) malloc (numStates * sizeof (struct GC_state)); \
       /* Create key */                                                  \
       if (pthread_key_create(&gcstate_key, MLtonGCCleanup)) {           \
         fprintf (stderr, "pthread_key_create failed: %s\n", strerror (errno)); \
@@ -131,15 +134,17 @@ void MLton_threadFunc (void* arg) {                                     \
       pthread_setspecific(gcstate_key, &gcState[0]);                    \
       GC_lateInit (&gcState[0]);                                        \
     }                                                                   \
-    /* Fill in per-processor data structures */                         \
-    for (procNo = 1; procNo < gcState[0].numberOfProcs; procNo++) {     \
+    /* Fill in per-processor (and per-gc-thread) data structures */     \
+    for (procNo = 1; procNo < numStates; procNo++) {                    \
       Duplicate (&gcState[procNo], &gcState[0]);                        \
       gcState[procNo].procStates = gcState;                             \
       gcState[procNo].procNumber = procNo;                              \
     }                                                                   \
     /* Set up tracing infrastructure */                                 \
-    for (procNo = 0; procNo < gcState[0].numberOfProcs; procNo++)       \
+    for (procNo = 0; procNo < numStates; procNo++)                      \
         GC_traceInit(&gcState[procNo]);                                 \
+    /* Start periodic statistics snapshots, if requested */             \
+    GC_statsSnapshotInit(&gcState[0]);                                  \
     /* Now create the threads */                                        \
     for (procNo = 1; procNo < gcState[0].numberOfProcs; procNo++) {     \
       if (pthread_create (&gcState[procNo].self, NULL, &MLton_threadFunc, (void *)&gcState[procNo])) { \
@@ -147,6 +152,8 @@ void MLton_threadFunc (void* arg) {                                     \
         exit (1);                                                       \
       }                                                                 \
     }                                                                   \
+    /* and the dedicated gc threads (@mpl gc-threads) */                \
+    GC_startGCThreads (&gcState[0]);                                    \
     MLton_threadFunc ((void *)&gcState[0]);                             \
   }
 
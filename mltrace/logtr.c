@@ -0,0 +1,418 @@
+/* Decoder for the binary logs written with `@mpl log-binary PREFIX --`.
+ * Reads PREFIX.sites and every PREFIX.<processor>, and prints the messages
+ * of all processors in timestamp order, formatted as the text log would
+ * have formatted them. */
+
+#include <glob.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "binary-log.h"
+
+struct Site {
+  char *module;
+  char *level;
+  char *function;
+  char *format;
+};
+
+struct Message {
+  uint64_t nanoseconds;
+  uint32_t processor;
+  uint32_t site;
+  uint32_t length;
+  const uint8_t *args;
+};
+
+static struct Site *sites = NULL;
+static size_t siteCount = 0;
+
+static struct Message *messages = NULL;
+static size_t messageCount = 0;
+static size_t messageCapacity = 0;
+
+static void *xmalloc(size_t size) {
+  void *p = malloc(size);
+  if (p == NULL) {
+    fprintf(stderr, "Could not allocate memory\n");
+    exit(1);
+  }
+  return p;
+}
+
+static void *xrealloc(void *p, size_t size) {
+  p = realloc(p, size);
+  if (p == NULL) {
+    fprintf(stderr, "Could not allocate memory\n");
+    exit(1);
+  }
+  return p;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: logtr [options] PREFIX\n"
+          "options:\n"
+          "  -m module          only display messages of this module\n"
+          "  -h                 display this message\n"
+    );
+}
+
+/* Read the whole file, checking its header. Returns NULL on failure. */
+static uint8_t *readLogFile(const char *fn, size_t *size,
+                            struct BinaryLogFileHeader *header) {
+  FILE *file;
+  uint8_t *contents;
+  long length;
+
+  if ((file = fopen(fn, "rb")) == NULL) {
+    fprintf(stderr, "%s: could not open file\n", fn);
+    return NULL;
+  }
+
+  fseek(file, 0, SEEK_END);
+  length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  if (length < (long)sizeof *header) {
+    fprintf(stderr, "%s: not a binary log\n", fn);
+    fclose(file);
+    return NULL;
+  }
+
+  contents = xmalloc(length);
+  if (fread(contents, 1, length, file) != (size_t)length) {
+    fprintf(stderr, "%s: could not read file\n", fn);
+    fclose(file);
+    free(contents);
+    return NULL;
+  }
+  fclose(file);
+
+  memcpy(header, contents, sizeof *header);
+  if (header->magic != BINARY_LOG_MAGIC) {
+    fprintf(stderr, "%s: not a binary log\n", fn);
+    free(contents);
+    return NULL;
+  }
+
+  *size = length;
+  return contents;
+}
+
+static char *copyString(const uint8_t *p, uint32_t length) {
+  char *s = xmalloc(length + 1);
+  memcpy(s, p, length);
+  s[length] = '\0';
+  return s;
+}
+
+static bool readSites(const char *prefix) {
+  char fn[4096];
+  struct BinaryLogFileHeader header;
+  size_t size;
+  uint8_t *contents;
+
+  snprintf(fn, sizeof fn, "%s.sites", prefix);
+  if ((contents = readLogFile(fn, &size, &header)) == NULL)
+    return false;
+
+  size_t offset = sizeof header;
+  while (offset + sizeof(struct BinaryLogSite) <= size) {
+    struct BinaryLogSite site;
+    memcpy(&site, contents + offset, sizeof site);
+    offset += sizeof site;
+
+    size_t strings = (size_t)site.moduleLength + site.levelLength
+                     + site.functionLength + site.formatLength;
+    if (offset + strings > size)
+      break;
+
+    if (site.id >= siteCount) {
+      size_t newCount = 2 * site.id + 1;
+      sites = xrealloc(sites, newCount * sizeof *sites);
+      memset(sites + siteCount, 0, (newCount - siteCount) * sizeof *sites);
+      siteCount = newCount;
+    }
+
+    struct Site *s = &sites[site.id];
+    s->module = copyString(contents + offset, site.moduleLength);
+    offset += site.moduleLength;
+    s->level = copyString(contents + offset, site.levelLength);
+    offset += site.levelLength;
+    s->function = copyString(contents + offset, site.functionLength);
+    offset += site.functionLength;
+    s->format = copyString(contents + offset, site.formatLength);
+    offset += site.formatLength;
+  }
+
+  free(contents);
+  return true;
+}
+
+/* The contents are kept alive, since the messages point into them. */
+static bool readMessages(const char *fn) {
+  struct BinaryLogFileHeader header;
+  size_t size;
+  uint8_t *contents;
+
+  if ((contents = readLogFile(fn, &size, &header)) == NULL)
+    return false;
+
+  size_t offset = sizeof header;
+  while (offset + sizeof(struct BinaryLogRecord) <= size) {
+    struct BinaryLogRecord record;
+    memcpy(&record, contents + offset, sizeof record);
+    offset += sizeof record;
+    if (offset + record.length > size)
+      break;
+
+    if (messageCount == messageCapacity) {
+      messageCapacity = (messageCapacity == 0) ? 1024 : 2 * messageCapacity;
+      messages = xrealloc(messages, messageCapacity * sizeof *messages);
+    }
+
+    struct Message *m = &messages[messageCount++];
+    m->nanoseconds = record.nanoseconds;
+    m->processor = header.processor;
+    m->site = record.site;
+    m->length = record.length;
+    m->args = contents + offset;
+    offset += record.length;
+  }
+
+  return true;
+}
+
+static int compareMessages(const void *a, const void *b) {
+  const struct Message *x = a, *y = b;
+  if (x->nanoseconds != y->nanoseconds)
+    return (x->nanoseconds < y->nanoseconds) ? -1 : 1;
+  if (x->processor != y->processor)
+    return (x->processor < y->processor) ? -1 : 1;
+  /* qsort is not stable, so keep the order of a processor's own messages */
+  return (x->args < y->args) ? -1 : (x->args > y->args);
+}
+
+#define FORMAT_STARS(out, size, spec, stars, value)                          \
+  ((stars)[0] == 2 ? snprintf(out, size, spec, (int)(stars)[1],              \
+                              (int)(stars)[2], value)                        \
+   : (stars)[0] == 1 ? snprintf(out, size, spec, (int)(stars)[1], value)     \
+   : snprintf(out, size, spec, value))
+
+/* Format one message into out, substituting its arguments the way printf
+ * would have. Arguments which were not recorded print as "<?>". */
+static void formatMessage(char *out, size_t size, const char *format,
+                          const uint8_t *args, uint32_t length) {
+  struct BinaryLogSpec spec;
+  const char *p = format;
+  const char *next;
+  uint32_t offset = 0;
+  size_t used = 0;
+
+#define APPEND(...)                                                          \
+  do {                                                                       \
+    if (used < size) {                                                       \
+      int n = snprintf(out + used, size - used, __VA_ARGS__);                \
+      if (n > 0)                                                             \
+        used += n;                                                           \
+    }                                                                        \
+  } while (false)
+
+#define NEXT_WORD(w)                                                         \
+  (offset + sizeof(uint64_t) <= length                                       \
+   ? (memcpy(&(w), args + offset, sizeof(uint64_t)),                         \
+      offset += sizeof(uint64_t), true)                                      \
+   : false)
+
+  out[0] = '\0';
+  while ((next = BinaryLog_nextSpec(p, &spec)) != NULL) {
+    char conversion[64];
+    char value[1024];
+    int64_t stars[3] = {0, 0, 0};
+    uint64_t word = 0;
+    bool ok = true;
+
+    APPEND("%.*s", (int)(spec.start - p), p);
+    p = next;
+
+    if (spec.length >= sizeof conversion) {
+      APPEND("%.*s", (int)spec.length, spec.start);
+      continue;
+    }
+    memcpy(conversion, spec.start, spec.length);
+    conversion[spec.length] = '\0';
+
+    for (uint32_t i = 0; i < spec.numStars; i++) {
+      uint64_t star = 0;
+      ok = ok && NEXT_WORD(star);
+      stars[0]++;
+      stars[1 + i] = (int64_t)star;
+    }
+    if (spec.kind != BLA_NONE && spec.kind != BLA_STRING)
+      ok = ok && NEXT_WORD(word);
+
+    if (!ok) {
+      APPEND("<?>");
+      continue;
+    }
+
+    switch (spec.kind) {
+    case BLA_NONE:
+      if (strcmp(conversion, "%%") == 0)
+        APPEND("%%");
+      else
+        APPEND("%s", conversion);
+      continue;
+    case BLA_INT:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (int)word);
+      break;
+    case BLA_LONG:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (long)word);
+      break;
+    case BLA_LLONG:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (long long)word);
+      break;
+    case BLA_SIZE:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (size_t)word);
+      break;
+    case BLA_INTMAX:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (intmax_t)word);
+      break;
+    case BLA_PTRDIFF:
+      FORMAT_STARS(value, sizeof value, conversion, stars, (ptrdiff_t)word);
+      break;
+    case BLA_DOUBLE: {
+      double d;
+      memcpy(&d, &word, sizeof d);
+      FORMAT_STARS(value, sizeof value, conversion, stars, d);
+      break;
+    }
+    case BLA_LDOUBLE: {
+      double d;
+      memcpy(&d, &word, sizeof d);
+      FORMAT_STARS(value, sizeof value, conversion, stars, (long double)d);
+      break;
+    }
+    case BLA_POINTER:
+      FORMAT_STARS(value, sizeof value, conversion, stars,
+                   (void *)(uintptr_t)word);
+      break;
+    case BLA_STRING: {
+      uint32_t stringLength;
+      if (offset + sizeof stringLength > length) {
+        APPEND("<?>");
+        continue;
+      }
+      memcpy(&stringLength, args + offset, sizeof stringLength);
+      if (offset + sizeof stringLength + stringLength > length) {
+        APPEND("<?>");
+        continue;
+      }
+      char *string = copyString(args + offset + sizeof stringLength,
+                                stringLength);
+      size_t padded = (sizeof stringLength + stringLength + 7) & ~(size_t)7;
+      offset += padded;
+      FORMAT_STARS(value, sizeof value, conversion, stars, string);
+      free(string);
+      break;
+    }
+    }
+
+    APPEND("%s", value);
+  }
+  APPEND("%s", p);
+
+#undef APPEND
+#undef NEXT_WORD
+}
+
+static void printMessage(struct Message *m, const char *module) {
+  static struct Site unknown = {"?", "?", "?", "<unknown site>"};
+  struct Site *site = &unknown;
+  char text[4096];
+
+  if (m->site < siteCount && sites[m->site].format != NULL)
+    site = &sites[m->site];
+
+  if (module != NULL && strcmp(module, site->module) != 0)
+    return;
+
+  formatMessage(text, sizeof text, site->format, m->args, m->length);
+  printf("%.9f %-6s [P%02" PRIu32 "|%s] %s: %s\n",
+         m->nanoseconds / 1E9,
+         site->level,
+         m->processor,
+         site->function,
+         site->module,
+         text);
+}
+
+int main(int argc, char *argv[]) {
+  int opt;
+  const char *module = NULL;
+  const char *prefix;
+  char pattern[4096];
+  glob_t files;
+
+  /* Parse command line arguments. */
+
+  while ((opt = getopt(argc, argv, "m:h")) != -1) {
+    switch (opt) {
+    case 'm':
+      module = optarg;
+      break;
+    case 'h':
+      usage();
+      return 0;
+    default:
+      fprintf(stderr, "invalid option '%c' (%d)\n", opt, opt);
+      usage();
+      return 1;
+    }
+  }
+
+  if (argc - optind != 1) {
+    usage();
+    return 1;
+  }
+  prefix = argv[optind];
+
+  /* Load the sites, then the messages of every processor. */
+
+  if (!readSites(prefix))
+    return 1;
+
+  snprintf(pattern, sizeof pattern, "%s.*", prefix);
+  if (glob(pattern, 0, NULL, &files) != 0) {
+    fprintf(stderr, "%s: no processor logs found\n", prefix);
+    return 1;
+  }
+
+  for (size_t i = 0; i < files.gl_pathc; i++) {
+    const char *fn = files.gl_pathv[i];
+    const char *suffix = fn + strlen(prefix) + 1;
+
+    if (strcmp(suffix, "sites") == 0)
+      continue;
+    if (strspn(suffix, "0123456789") != strlen(suffix))
+      continue;
+    if (!readMessages(fn))
+      return 1;
+  }
+  globfree(&files);
+
+  /* Print them all in order. */
+
+  if (messageCount > 0)
+    qsort(messages, messageCount, sizeof *messages, compareMessages);
+
+  for (size_t i = 0; i < messageCount; i++)
+    printMessage(&messages[i], module);
+
+  return 0;
+}
@@ -60,12 +60,52 @@ static const char *EventKindStrings[] = {
   [EVENT_MERGED_HEAP]           = "MERGED_HEAP",
 
   [EVENT_COPY]                  = "COPY",
+
+  [EVENT_STEAL]                 = "STEAL",
+  [EVENT_TASK_START]            = "TASK_START",
+  [EVENT_TASK_FINISH]           = "TASK_FINISH",
+  [EVENT_DEQUE_DEPTH]           = "DEQUE_DEPTH",
+
+  [EVENT_CC_ROOT_ENTER]         = "CC_ROOT_ENTER",
+  [EVENT_CC_ROOT_LEAVE]         = "CC_ROOT_LEAVE",
+  [EVENT_CC_INTERNAL_ENTER]     = "CC_INTERNAL_ENTER",
+  [EVENT_CC_INTERNAL_LEAVE]     = "CC_INTERNAL_LEAVE",
+
+  [EVENT_EBR_EPOCH_ADVANCE]     = "EBR_EPOCH_ADVANCE",
+
+  [EVENT_CHUNK_MMAP]            = "CHUNK_MMAP",
 };
 
+/* ENTER/LEAVE pairs, which the Chrome exporter turns into duration
+ * slices. Every other event becomes an instant. */
+struct SlicePair {
+  int enter;
+  int leave;
+  const char *name;
+};
+
+static const struct SlicePair SlicePairs[] = {
+  { EVENT_RUNTIME_ENTER,         EVENT_RUNTIME_LEAVE,         "runtime" },
+  { EVENT_GC_ENTER,              EVENT_GC_LEAVE,              "GC" },
+  { EVENT_PROMOTION_ENTER,       EVENT_PROMOTION_LEAVE,       "promotion" },
+  { EVENT_ARRAY_ALLOCATE_ENTER,  EVENT_ARRAY_ALLOCATE_LEAVE,  "array allocate" },
+  { EVENT_LOCK_TAKE_ENTER,       EVENT_LOCK_TAKE_LEAVE,       "lock take" },
+  { EVENT_GSECTION_BEGIN_ENTER,  EVENT_GSECTION_BEGIN_LEAVE,  "gsection begin" },
+  { EVENT_GSECTION_END_ENTER,    EVENT_GSECTION_END_LEAVE,    "gsection end" },
+  { EVENT_TASK_START,            EVENT_TASK_FINISH,           "task" },
+  { EVENT_CC_ROOT_ENTER,         EVENT_CC_ROOT_LEAVE,         "root CC" },
+  { EVENT_CC_INTERNAL_ENTER,     EVENT_CC_INTERNAL_LEAVE,     "internal CC" },
+};
+
+#define SlicePairCount (sizeof SlicePairs / sizeof *SlicePairs)
+
 void processFiles(size_t filecount, FILE **files, void (*func)(struct Event *));
 
 void printEventText(struct Event *);
 void printEventCSV(struct Event *);
+void printEventChrome(struct Event *);
+void beginChrome(void);
+void endChrome(void);
 
 void usage() {
   fprintf(stderr,
@@ -73,6 +113,7 @@ void usage() {
           "options:\n"
           "  -d                 display contents in human-readable format\n"
           "  -c                 display contents in CSV format\n"
+          "  -j                 display contents in Chrome/Perfetto JSON format\n"
           "  -h                 display this message\n"
     );
 }
@@ -80,13 +121,13 @@ void usage() {
 int main(int argc, char *argv[]) {
   int opt;
   size_t fcount;
-  bool display = false, csv = false;
+  bool display = false, csv = false, chrome = false;
   bool read_stdin = false;
   FILE **files;
 
   /* Parse command line arguments. */
 
-  while ((opt = getopt(argc, argv, "dhc")) != -1) {
+  while ((opt = getopt(argc, argv, "dhcj")) != -1) {
     switch (opt) {
     case 'd':
       display = true;
@@ -94,6 +135,9 @@ int main(int argc, char *argv[]) {
     case 'c':
       csv = true;
       break;
+    case 'j':
+      chrome = true;
+      break;
     case 'h':
       usage();
       return 0;
@@ -138,6 +182,12 @@ int main(int argc, char *argv[]) {
   if (csv)
     processFiles(fcount, files, printEventCSV);
 
+  if (chrome) {
+    beginChrome();
+    processFiles(fcount, files, printEventChrome);
+    endChrome();
+  }
+
   /* Close and free files. */
 
   if (!read_stdin)
@@ -203,7 +253,6 @@ void printEventText(struct Event *event) {
   switch(event->kind) {
   case EVENT_INIT:
   case EVENT_LAUNCH:
-  case EVENT_FINISH:
   case EVENT_GC_ENTER:
   case EVENT_GC_LEAVE:
   case EVENT_GC_ABORT:
@@ -219,6 +268,10 @@ void printEventText(struct Event *event) {
   case EVENT_ARRAY_ALLOCATE_LEAVE:
     break;
 
+  case EVENT_FINISH:
+    printf("dropped = %lld", event->arg1);
+    break;
+
   case EVENT_THREAD_COPY:
     printf("from = %llx, to = %llx", event->arg1, event->arg2);
     break;
@@ -277,6 +330,38 @@ void printEventText(struct Event *event) {
            event->arg1, event->arg2, event->arg3);
     break;
 
+  case EVENT_STEAL:
+    printf("victim = %lld, depth = %lld", event->arg1, event->arg2);
+    break;
+
+  case EVENT_TASK_START:
+  case EVENT_TASK_FINISH:
+  case EVENT_DEQUE_DEPTH:
+    printf("depth = %lld", event->arg1);
+    break;
+
+  case EVENT_CC_ROOT_ENTER:
+    printf("hh = %llx, size = %lld", event->arg1, event->arg2);
+    break;
+
+  case EVENT_CC_INTERNAL_ENTER:
+    printf("hh = %llx, size = %lld, depth = %lld",
+           event->arg1, event->arg2, event->arg3);
+    break;
+
+  case EVENT_CC_ROOT_LEAVE:
+  case EVENT_CC_INTERNAL_LEAVE:
+    printf("size = %lld, live = %lld", event->arg1, event->arg2);
+    break;
+
+  case EVENT_EBR_EPOCH_ADVANCE:
+    printf("epoch = %lld", event->arg1);
+    break;
+
+  case EVENT_CHUNK_MMAP:
+    printf("chunk = %llx, size = %lld", event->arg1, event->arg2);
+    break;
+
   default:
     printf("?1 = %llx, ?2 = %llx, ?3 = %llx",
            event->arg1, event->arg2, event->arg3);
@@ -284,3 +369,144 @@ void printEventText(struct Event *event) {
 
   printf(")\n");
 }
+
+/* Chrome Trace Event format, which both chrome://tracing and Perfetto
+ * understand. Each processor gets its own track (tid), and matching
+ * ENTER/LEAVE events on a processor become a single complete ("X") event.
+ * Timestamps are in microseconds. */
+
+struct OpenSlice {
+  size_t pair;
+  struct Event start;
+};
+
+struct ProcSlices {
+  struct OpenSlice *open;
+  size_t count;
+  size_t capacity;
+  bool seen;
+};
+
+static struct ProcSlices *chromeProcs = NULL;
+static size_t chromeProcCount = 0;
+static bool chromeFirst = true;
+static size_t chromeUnmatched = 0;
+
+static struct ProcSlices *chromeProc(uintptr_t id) {
+  if (id >= chromeProcCount) {
+    size_t newCount = 2 * id + 1;
+    chromeProcs = realloc(chromeProcs, newCount * sizeof *chromeProcs);
+    if (chromeProcs == NULL) {
+      fprintf(stderr, "Could not allocate memory\n");
+      exit(1);
+    }
+    for (size_t i = chromeProcCount; i < newCount; i++) {
+      chromeProcs[i].open = NULL;
+      chromeProcs[i].count = 0;
+      chromeProcs[i].capacity = 0;
+      chromeProcs[i].seen = false;
+    }
+    chromeProcCount = newCount;
+  }
+  return &chromeProcs[id];
+}
+
+static double chromeTime(struct Event *event) {
+  return event->ts.tv_sec * 1E6 + event->ts.tv_nsec / 1E3;
+}
+
+static void chromeSeparator(void) {
+  if (!chromeFirst)
+    printf(",\n");
+  chromeFirst = false;
+}
+
+static void chromeArgs(struct Event *event) {
+  printf("\"args\":{\"arg1\":%llu,\"arg2\":%llu,\"arg3\":%llu}",
+         event->arg1, event->arg2, event->arg3);
+}
+
+static const char *chromeKindName(int kind) {
+  if (kind > 0 && (size_t)kind < EventKindCount && EventKindStrings[kind])
+    return EventKindStrings[kind];
+  return "USER";
+}
+
+void beginChrome(void) {
+  printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+}
+
+void endChrome(void) {
+  for (size_t i = 0; i < chromeProcCount; i++) {
+    if (!chromeProcs[i].seen)
+      continue;
+    chromeSeparator();
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%zu,"
+           "\"args\":{\"name\":\"proc %zu\"}}", i, i);
+    chromeUnmatched += chromeProcs[i].count;
+    free(chromeProcs[i].open);
+  }
+  free(chromeProcs);
+  printf("\n]}\n");
+
+  if (chromeUnmatched > 0)
+    fprintf(stderr, "warning: %zu slices were never closed\n", chromeUnmatched);
+}
+
+void printEventChrome(struct Event *event) {
+  struct ProcSlices *proc = chromeProc(event->argptr);
+  proc->seen = true;
+
+  for (size_t p = 0; p < SlicePairCount; p++) {
+    if (event->kind == SlicePairs[p].enter) {
+      if (proc->count == proc->capacity) {
+        proc->capacity = proc->capacity == 0 ? 16 : 2 * proc->capacity;
+        proc->open = realloc(proc->open, proc->capacity * sizeof *proc->open);
+        if (proc->open == NULL) {
+          fprintf(stderr, "Could not allocate memory\n");
+          exit(1);
+        }
+      }
+      proc->open[proc->count].pair = p;
+      proc->open[proc->count].start = *event;
+      proc->count++;
+      return;
+    }
+
+    if (event->kind == SlicePairs[p].leave) {
+      /* close the innermost open slice of this kind */
+      size_t i = proc->count;
+      while (i > 0 && proc->open[i-1].pair != p)
+        i--;
+      if (i == 0) {
+        chromeUnmatched++;
+        return;
+      }
+
+      struct Event *start = &proc->open[i-1].start;
+      chromeSeparator();
+      printf("{\"name\":\"%s\",\"cat\":\"mpl\",\"ph\":\"X\","
+             "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%" PRIuPTR ",",
+             SlicePairs[p].name,
+             chromeTime(start),
+             chromeTime(event) - chromeTime(start),
+             event->argptr);
+      chromeArgs(start);
+      printf("}");
+
+      for (; i < proc->count; i++)
+        proc->open[i-1] = proc->open[i];
+      proc->count--;
+      return;
+    }
+  }
+
+  chromeSeparator();
+  printf("{\"name\":\"%s\",\"cat\":\"mpl\",\"ph\":\"i\",\"s\":\"t\","
+         "\"ts\":%.3f,\"pid\":0,\"tid\":%" PRIuPTR ",",
+         chromeKindName(event->kind),
+         chromeTime(event),
+         event->argptr);
+  chromeArgs(event);
+  printf("}");
+}
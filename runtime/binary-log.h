@@ -0,0 +1,156 @@
+/* The format of binary logs (`@mpl log-binary PREFIX`), shared by the
+ * runtime and the decoder (mltrace/logtr.c).
+ *
+ * Instead of formatting each LOG message, the runtime appends the raw
+ * arguments to a buffer of the processor, and the decoder formats them
+ * later. There are two kinds of files, both in host byte order and both
+ * beginning with a struct BinaryLogFileHeader:
+ *
+ *   PREFIX.sites  describes every LOG call site that was used: a struct
+ *                 BinaryLogSite followed by the names of its module, level
+ *                 and function, and its format string (without NULs).
+ *
+ *   PREFIX.<p>    holds the messages of processor p: a struct
+ *                 BinaryLogRecord followed by `length` bytes of arguments.
+ *                 Integers, pointers and doubles take 8 bytes each. A string
+ *                 is a 4-byte length followed by its bytes, padded to 8.
+ *                 Arguments which did not fit are missing from the end.
+ */
+
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <iso646.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BINARY_LOG_MAGIC 0x3147534d4c504dULL /* "MPLMSG1" */
+
+struct BinaryLogFileHeader {
+  uint64_t magic;
+  uint32_t processor; /* UINT32_MAX for the sites file */
+  uint32_t reserved;
+};
+
+struct BinaryLogSite {
+  uint32_t id;
+  uint32_t moduleLength;
+  uint32_t levelLength;
+  uint32_t functionLength;
+  uint32_t formatLength;
+  uint32_t reserved;
+};
+
+struct BinaryLogRecord {
+  uint64_t nanoseconds; /* CLOCK_MONOTONIC */
+  uint32_t site;
+  uint32_t length;
+};
+
+/* How each conversion of a format string takes its argument. Integers are
+ * distinguished only by the C type they are passed as. */
+enum BinaryLogArgKind {
+  BLA_NONE,    /* "%%", or a conversion which takes no argument */
+  BLA_INT,
+  BLA_LONG,
+  BLA_LLONG,
+  BLA_SIZE,
+  BLA_INTMAX,
+  BLA_PTRDIFF,
+  BLA_DOUBLE,
+  BLA_LDOUBLE, /* logged as a double */
+  BLA_POINTER,
+  BLA_STRING
+};
+
+struct BinaryLogSpec {
+  const char *start;  /* the '%' */
+  size_t length;      /* up to and including the conversion character */
+  uint32_t numStars;  /* '*' widths and precisions, each an int argument */
+  enum BinaryLogArgKind kind;
+};
+
+/* Find the first conversion at or after p. Returns NULL if there is none,
+ * and otherwise a pointer just past it. */
+static inline const char *BinaryLog_nextSpec(const char *p,
+                                             struct BinaryLogSpec *spec) {
+  while ('\0' != *p and '%' != *p)
+    p++;
+  if ('\0' == *p)
+    return NULL;
+
+  const char *q = p + 1;
+  spec->start = p;
+  spec->numStars = 0;
+  spec->kind = BLA_NONE;
+
+  if ('%' == *q) {
+    spec->length = 2;
+    return q + 1;
+  }
+
+  while ('\0' != *q and NULL != strchr("-+ #0'", *q))
+    q++;
+  for (int part = 0; part < 2; part++) {
+    if ('*' == *q) {
+      spec->numStars++;
+      q++;
+    } else {
+      while ('0' <= *q and *q <= '9')
+        q++;
+    }
+    if (0 == part and '.' == *q)
+      q++;
+    else
+      break;
+  }
+
+  enum BinaryLogArgKind integer = BLA_INT;
+  bool longDouble = false;
+  switch (*q) {
+    case 'h': q++; if ('h' == *q) q++; break;
+    case 'l': q++; integer = BLA_LONG; if ('l' == *q) { q++; integer = BLA_LLONG; } break;
+    case 'q': q++; integer = BLA_LLONG; break;
+    case 'z': q++; integer = BLA_SIZE; break;
+    case 'j': q++; integer = BLA_INTMAX; break;
+    case 't': q++; integer = BLA_PTRDIFF; break;
+    case 'L': q++; longDouble = true; break;
+    default: break;
+  }
+
+  switch (*q) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+      spec->kind = integer;
+      break;
+    case 'c':
+      spec->kind = BLA_INT;
+      break;
+    case 'e': case 'E': case 'f': case 'F':
+    case 'g': case 'G': case 'a': case 'A':
+      spec->kind = longDouble ? BLA_LDOUBLE : BLA_DOUBLE;
+      break;
+    case 's':
+      spec->kind = BLA_STRING;
+      break;
+    case 'p':
+      spec->kind = BLA_POINTER;
+      break;
+    case '\0':
+      /* a stray '%' at the end; print it as is */
+      spec->numStars = 0;
+      spec->length = (size_t)(q - p);
+      return q;
+    default:
+      /* %n and anything unknown are printed as is */
+      spec->numStars = 0;
+      break;
+  }
+
+  q++;
+  spec->length = (size_t)(q - p);
+  return q;
+}
+
+#endif /* BINARY_LOG_H */
@@ -20,14 +20,6 @@
 #define LOCAL_USED_FOR_ASSERT  __attribute__ ((unused))
 #endif
 
-#ifdef ENABLE_TRACING
-#define ARG_USED_FOR_TRACING
-#define LOCAL_USED_FOR_TRACING
-#else
-#define ARG_USED_FOR_TRACING  __attribute__ ((unused))
-#define LOCAL_USED_FOR_TRACING  __attribute__ ((unused))
-#endif
-
 #include "gc/virtual-memory.c"
 #include "gc/align.c"
 #include "gc/read_write.c"
@@ -39,6 +31,7 @@ extern C_Pthread_Key_t gcstate_key;
 #include "gc/assign.c"
 #include "gc/atomic.c"
 #include "gc/call-stack.c"
+#include "gc/census.c"
 #include "gc/chunk.c"
 #include "gc/concurrent-collection.c"
 #include "gc/concurrent-stack.c"
@@ -58,6 +51,7 @@ extern C_Pthread_Key_t gcstate_key;
 #include "gc/garbage-collection.c"
 #include "gc/gc_state.c"
 #include "gc/handler.c"
+#include "gc/heap-profile.c"
 #include "gc/heap.c"
 #include "gc/hierarchical-heap.c"
 #include "gc/hierarchical-heap-collection.c"
@@ -75,6 +69,7 @@ extern C_Pthread_Key_t gcstate_key;
 #include "gc/objptr.c"
 #include "gc/pack.c"
 #include "gc/parallel.c"
+#include "gc/perf-counters.c"
 #include "gc/pointer.c"
 #include "gc/profiling.c"
 #include "gc/remembered-set.c"
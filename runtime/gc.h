@@ -65,6 +65,9 @@ typedef GC_state GCState_t;
 #include "gc/sequence-allocate.h"
 #include "gc/call-stack.h"
 #include "gc/profiling.h"
+#include "gc/perf-counters.h"
+#include "gc/heap-profile.h"
+#include "gc/census.h"
 #include "gc/rusage.h"
 #include "gc/termination.h"
 #include "gc/gc_state.h"
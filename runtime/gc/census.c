@@ -0,0 +1,171 @@
+static const uint32_t censusWidth[NUM_CENSUS_TABLES] = {3, 6, 5};
+
+/* Append a zeroed row to a table. The pointer is only valid until the next
+ * row is added to the same table. */
+static uint64_t *censusAddRow(struct GC_census *census,
+                              enum GC_censusTable table) {
+  size_t width = censusWidth[table];
+
+  if (census->length[table] == census->capacity[table]) {
+    size_t capacity =
+      (0 == census->capacity[table]) ? 64 : 2 * census->capacity[table];
+    uint64_t *rows =
+      realloc(census->rows[table], capacity * width * sizeof(uint64_t));
+    if (NULL == rows) {
+      DIE("could not grow census table to %zu rows", capacity);
+    }
+    census->rows[table] = rows;
+    census->capacity[table] = capacity;
+  }
+
+  uint64_t *row = &(census->rows[table][census->length[table] * width]);
+  memset(row, 0, width * sizeof(uint64_t));
+  census->length[table]++;
+  return row;
+}
+
+/* We only need the size of each object, so skip over its fields. */
+static bool censusSkipObjptrs(__attribute__((unused)) GC_state s,
+                              __attribute__((unused)) pointer p,
+                              __attribute__((unused)) void *env) {
+  return FALSE;
+}
+
+static void censusNoObjptr(__attribute__((unused)) GC_state s,
+                           __attribute__((unused)) objptr *opp,
+                           __attribute__((unused)) void *env) {
+  return;
+}
+
+/* Tally the objects of one chunk, into its own row and the rows of its level
+ * (`level`) and of each object type (`typeCounts`, two per type index). */
+static void censusChunk(GC_state s,
+                        struct GC_census *census,
+                        HM_chunk chunk,
+                        uint32_t depth,
+                        uint64_t *level,
+                        uint64_t *typeCounts) {
+  struct GC_objptrPredicateClosure skipClosure =
+    {.fun = censusSkipObjptrs, .env = NULL};
+  struct GC_foreachObjptrClosure noClosure =
+    {.fun = censusNoObjptr, .env = NULL};
+
+  uint64_t objects = 0;
+  uint64_t bytes = 0;
+
+  pointer p = HM_getChunkStart(chunk);
+  while (p < HM_getChunkFrontier(chunk)) {
+    pointer start = p;
+    p = advanceToObjectData(s, p);
+    GC_header header = getHeader(p);
+    uint32_t typeIndex = (header & TYPE_INDEX_MASK) >> TYPE_INDEX_SHIFT;
+    assert(typeIndex < s->objectTypesLength);
+
+    p = foreachObjptrInObject(s, p, &skipClosure, &noClosure, FALSE);
+
+    size_t size = (size_t)(p - start);
+    typeCounts[2*typeIndex]++;
+    typeCounts[2*typeIndex + 1] += size;
+    objects++;
+    bytes += size;
+  }
+
+  uint64_t *row = censusAddRow(census, CENSUS_CHUNKS);
+  row[0] = depth;
+  row[1] = HM_getChunkSize(chunk);
+  row[2] = HM_getChunkUsedSize(chunk);
+  row[3] = objects;
+  row[4] = bytes;
+
+  level[1]++;
+  level[4] += objects;
+  level[5] += bytes;
+}
+
+void GC_census(GC_state s) {
+  GC_thread thread = getThreadCurrent(s);
+
+  if (NULL == s->census) {
+    s->census = calloc_safe(1, sizeof(struct GC_census));
+  }
+  struct GC_census *census = s->census;
+  for (int t = 0; t < NUM_CENSUS_TABLES; t++) {
+    census->length[t] = 0;
+  }
+
+  /* make the frontier of the current chunk reflect the mutator's bumps */
+  HM_HH_updateValues(thread, s->frontier);
+
+  /* Same as for a local collection: claim as many levels as we can. Before
+   * the scheduler registers its deque, no one else can be looking at this
+   * heap. */
+  uint32_t originalLocalScope = 0;
+  uint32_t minDepth = 0;
+  bool claimed =
+    (s->wsQueueTop != BOGUS_OBJPTR && s->wsQueueBot != BOGUS_OBJPTR);
+  if (claimed) {
+    originalLocalScope = pollCurrentLocalScope(s);
+    minDepth = max(thread->minLocalCollectionDepth, originalLocalScope);
+    while (minDepth > thread->minLocalCollectionDepth &&
+           tryClaimLocalScope(s)) {
+      minDepth--;
+    }
+  }
+
+  uint64_t *typeCounts = calloc_safe(2 * s->objectTypesLength, sizeof(uint64_t));
+
+  for (HM_HierarchicalHeap hh = thread->hierarchicalHeap;
+       NULL != hh && HM_HH_getDepth(hh) >= minDepth;
+       hh = hh->nextAncestor)
+  {
+    HM_chunkList list = HM_HH_getChunkList(hh);
+    uint32_t depth = HM_HH_getDepth(hh);
+
+    uint64_t *level = censusAddRow(census, CENSUS_LEVELS);
+    level[0] = depth;
+    level[2] = HM_getChunkListSize(list);
+    level[3] = HM_getChunkListUsedSize(list);
+
+    for (HM_chunk chunk = HM_getChunkListFirstChunk(list);
+         NULL != chunk;
+         chunk = chunk->nextChunk)
+    {
+      censusChunk(s, census, chunk, depth, level, typeCounts);
+    }
+  }
+
+  if (claimed) {
+    releaseLocalScope(s, originalLocalScope);
+  }
+
+  for (uint32_t i = 0; i < s->objectTypesLength; i++) {
+    if (0 == typeCounts[2*i]) {
+      continue;
+    }
+    uint64_t *row = censusAddRow(census, CENSUS_TYPES);
+    row[0] = i;
+    row[1] = typeCounts[2*i];
+    row[2] = typeCounts[2*i + 1];
+  }
+
+  free(typeCounts);
+}
+
+uintmax_t GC_getCensusLength(GC_state s, uint32_t table) {
+  assert(table < NUM_CENSUS_TABLES);
+  if (NULL == s->census) {
+    return 0;
+  }
+  return s->census->length[table];
+}
+
+uintmax_t GC_getCensusField(GC_state s,
+                            uint32_t table,
+                            uint32_t row,
+                            uint32_t field) {
+  assert(table < NUM_CENSUS_TABLES);
+  assert(NULL != s->census);
+  assert(row < s->census->length[table]);
+  assert(field < censusWidth[table]);
+  return s->census->rows[table][row * censusWidth[table] + field];
+}
@@ -0,0 +1,50 @@
+/** Heap census.
+  *
+  * A census walks every object of the current thread's hierarchical heap and
+  * tallies the objects and bytes found, by object type index, by depth, and
+  * by chunk. For each level it also records the size and used size of its
+  * chunk list, so that fragmentation (size - usedSize) can be reported
+  * alongside the live data.
+  *
+  * Only the levels which the thread owns exclusively (its local scope) are
+  * walked; shallower levels may be concurrently modified by other processors.
+  *
+  * The result is kept in the GC state of the processor that took it, and is
+  * read back one field at a time by GC_getCensusField, until the next census.
+  */
+
+#ifndef CENSUS_H_
+#define CENSUS_H_
+
+#if (defined (MLTON_GC_INTERNAL_TYPES))
+
+/* must match the constants in basis-library/mpl/gc.sml */
+enum GC_censusTable {
+  CENSUS_TYPES,  /* typeIndex, objects, bytes */
+  CENSUS_LEVELS, /* depth, chunks, size, usedSize, objects, bytes */
+  CENSUS_CHUNKS, /* depth, size, usedSize, objects, bytes */
+  NUM_CENSUS_TABLES
+};
+
+struct GC_census {
+  uint64_t *rows[NUM_CENSUS_TABLES];
+  size_t length[NUM_CENSUS_TABLES];
+  size_t capacity[NUM_CENSUS_TABLES];
+};
+
+#endif /* MLTON_GC_INTERNAL_TYPES */
+
+#if (defined (MLTON_GC_INTERNAL_BASIS))
+
+/* Take a census of the current thread's heap, replacing the previous one. */
+PRIVATE void GC_census(GC_state s);
+
+PRIVATE uintmax_t GC_getCensusLength(GC_state s, uint32_t table);
+PRIVATE uintmax_t GC_getCensusField(GC_state s,
+                                    uint32_t table,
+                                    uint32_t row,
+                                    uint32_t field);
+
+#endif /* MLTON_GC_INTERNAL_BASIS */
+
+#endif /* CENSUS_H_ */
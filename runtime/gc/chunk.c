@@ -30,6 +30,7 @@ static void HM_assertChunkListInvariants(HM_chunkList chunkList);
 
 size_t HM_BLOCK_SIZE;
 size_t HM_ALLOC_SIZE;
+size_t HM_LINE_SIZE;
 
 HM_chunk mmapNewChunk(size_t chunkWidth);
 HM_chunk mmapNewChunk(size_t chunkWidth) {
@@ -55,6 +56,8 @@ void HM_configChunks(GC_state s) {
   assert(isAligned(s->controls->allocChunkSize, s->controls->blockSize));
   HM_BLOCK_SIZE = s->controls->blockSize;
   HM_ALLOC_SIZE = s->controls->allocChunkSize;
+  HM_LINE_SIZE = HM_BLOCK_SIZE / HM_LINES_PER_BLOCK;
+  assert(HM_LINE_SIZE * HM_LINES_PER_BLOCK == HM_BLOCK_SIZE);
 }
 
 static void HM_prependChunk(HM_chunkList list, HM_chunk chunk) {
@@ -104,7 +107,14 @@ HM_chunk HM_initializeChunk(pointer start, pointer end) {
   chunk->levelHead = NULL;
   chunk->startGap = 0;
   chunk->mightContainMultipleObjects = TRUE;
+  chunk->keepInPlace = FALSE;
+  chunk->tenured = FALSE;
+  chunk->levelHeadTag = 0;
   chunk->tmpHeap = NULL;
+  chunk->heapSamples = NULL;
+  chunk->liveLines = 0;
+  chunk->markBits = NULL;
+  chunk->localLiveBytes = 0;
   chunk->magic = CHUNK_MAGIC;
 
 #if ASSERT
@@ -144,7 +154,7 @@ static HM_chunk splitChunkAt(HM_chunkList list, HM_chunk chunk, pointer splitPoi
   pointer limit = chunk->limit;
   chunk->limit = splitPoint;
   HM_chunk result = HM_initializeChunk(splitPoint, limit);
-  result->levelHead = chunk->levelHead;
+  HM_setLevelHead(result, chunk->levelHead);
 
   if (NULL == chunk->nextChunk) {
     assert(list->lastChunk == chunk);
@@ -314,6 +324,16 @@ HM_chunk HM_checkSharedListForChunk(GC_state s, size_t bytesRequested) {
   return foundChunk;
 }
 
+/* Reset the fields which a chunk taken from a free list may have kept from
+ * its last use. */
+static inline void resetFreeChunkFields(HM_chunk chunk) {
+  chunk->mightContainMultipleObjects = TRUE;
+  chunk->keepInPlace = FALSE;
+  chunk->tenured = FALSE;
+  chunk->levelHeadTag = 0;
+  chunk->tmpHeap = NULL;
+}
+
 HM_chunk HM_getFreeChunk(GC_state s, size_t bytesRequested) {
   HM_chunk chunk = getFreeListSmall(s)->firstChunk;
 
@@ -351,8 +371,7 @@ HM_chunk HM_getFreeChunk(GC_state s, size_t bytesRequested) {
     /* if this chunk is good, then we're done. */
     if (chunkHasBytesFree(chunk, bytesRequested)) {
       assert(chunk->frontier == HM_getChunkStart(chunk));
-      chunk->mightContainMultipleObjects = TRUE;
-      chunk->tmpHeap = NULL;
+      resetFreeChunkFields(chunk);
       splitChunkFront(getFreeListSmall(s), chunk, bytesRequested);
       HM_unlinkChunk(getFreeListSmall(s), chunk);
       return chunk;
@@ -371,8 +390,7 @@ HM_chunk HM_getFreeChunk(GC_state s, size_t bytesRequested) {
 
   /* if this chunk is good, we're done. */
   if (chunkHasBytesFree(chunk, bytesRequested)) {
-    chunk->mightContainMultipleObjects = TRUE;
-    chunk->tmpHeap = NULL;
+    resetFreeChunkFields(chunk);
     splitChunkFront(getFreeListLarge(s), chunk, bytesRequested);
     HM_unlinkChunk(getFreeListLarge(s), chunk);
     return chunk;
@@ -391,8 +409,7 @@ HM_chunk HM_getFreeChunk(GC_state s, size_t bytesRequested) {
   if(chunk!=NULL) {
     chunk->startGap = 0;
     chunk->frontier = HM_getChunkStart(chunk);
-    chunk->mightContainMultipleObjects = TRUE;
-    chunk->tmpHeap = NULL;
+    resetFreeChunkFields(chunk);
     assert(chunkHasBytesFree(chunk, bytesRequested));
 
     HM_chunkList lis = getFreeListSmall(s);
@@ -436,11 +453,13 @@ HM_chunk HM_getFreeChunk(GC_state s, size_t bytesRequested) {
     }
   }
 
+  Trace2(EVENT_CHUNK_MMAP, (EventInt)chunk, HM_getChunkSize(chunk));
+  S_addHeapOccupancy(s, HM_getChunkSize(chunk));
+
   HM_prependChunk(getFreeListLarge(s), chunk);
   assert(chunk->frontier == HM_getChunkStart(chunk));
   assert(chunkHasBytesFree(chunk, bytesRequested));
-  chunk->mightContainMultipleObjects = TRUE;
-  chunk->tmpHeap = NULL;
+  resetFreeChunkFields(chunk);
   splitChunkFront(getFreeListLarge(s), chunk, bytesRequested);
   HM_unlinkChunk(getFreeListLarge(s), chunk);
   return chunk;
@@ -456,6 +475,9 @@ HM_chunk HM_allocateChunk(HM_chunkList list, size_t bytesRequested) {
     return NULL;
   }
 
+  /* the chunk may have been freed without the heap profiler noticing */
+  HP_discardSamples(chunk);
+
   s->cumulativeStatistics->bytesAllocated += HM_getChunkSize(chunk);
 
   assert(chunk->frontier == HM_getChunkStart(chunk));
@@ -499,7 +521,7 @@ void HM_unlinkChunk(HM_chunkList list, HM_chunk chunk) {
   list->size -= HM_getChunkSize(chunk);
   list->usedSize -= HM_getChunkUsedSize(chunk);
 
-  chunk->levelHead = NULL;
+  HM_setLevelHead(chunk, NULL);
   chunk->prevChunk = NULL;
   chunk->nextChunk = NULL;
 
@@ -658,7 +680,53 @@ HM_HierarchicalHeap HM_getLevelHead(HM_chunk chunk) {
   return cursor->payload;
 }
 
+/* The cache may be read by any processor while another fills it, so it is
+ * read like a seqlock: the entry only counts if the tag is the same before
+ * and after, and still matches the heap. Returns NULL on a miss. */
+static inline HM_HierarchicalHeap readLevelHeadCache(HM_chunk chunk) {
+  uint64_t tag = __atomic_load_n(&(chunk->levelHeadTag), __ATOMIC_ACQUIRE);
+  if (0 == tag || HM_LEVEL_HEAD_CACHE_BUSY == tag) {
+    return NULL;
+  }
+  HM_HierarchicalHeap levelHead = chunk->cachedLevelHead;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (tag != __atomic_load_n(&(chunk->levelHeadTag), __ATOMIC_RELAXED) ||
+      tag != __atomic_load_n(&(levelHead->cacheTag), __ATOMIC_ACQUIRE))
+  {
+    return NULL;
+  }
+  return levelHead;
+}
+
+/* Cache `levelHead`, found by a lookup which has just finished. Only one
+ * processor may write the cache at a time; the others skip it. */
+static inline void writeLevelHeadCache(HM_chunk chunk,
+                                       HM_HierarchicalHeap levelHead) {
+  /* If levelHead has been linked into another heap since the lookup, its tag
+   * is already 0 here; if that happens later, the tag stops matching. */
+  uint64_t tag = __atomic_load_n(&(levelHead->cacheTag), __ATOMIC_ACQUIRE);
+  if (0 == tag) {
+    return;
+  }
+
+  uint64_t old = __atomic_load_n(&(chunk->levelHeadTag), __ATOMIC_RELAXED);
+  if (HM_LEVEL_HEAD_CACHE_BUSY == old ||
+      !__atomic_compare_exchange_n(&(chunk->levelHeadTag), &old,
+                                   HM_LEVEL_HEAD_CACHE_BUSY, FALSE,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+  {
+    return;
+  }
+  chunk->cachedLevelHead = levelHead;
+  __atomic_store_n(&(chunk->levelHeadTag), tag, __ATOMIC_RELEASE);
+}
+
 HM_HierarchicalHeap HM_getLevelHeadPathCompress(HM_chunk chunk) {
+  HM_HierarchicalHeap cached = readLevelHeadCache(chunk);
+  if (NULL != cached) {
+    return cached;
+  }
+
   HM_HierarchicalHeap levelHead = HM_getLevelHead(chunk);
   assert(levelHead != NULL);
   HM_UnionFindNode topNode = HM_HH_getUFNode(levelHead);
@@ -666,6 +734,7 @@ HM_HierarchicalHeap HM_getLevelHeadPathCompress(HM_chunk chunk) {
 
   /* fast path */
   if (chunk->levelHead == topNode) {
+    writeLevelHeadCache(chunk, levelHead);
     return levelHead;
   }
 
@@ -678,6 +747,7 @@ HM_HierarchicalHeap HM_getLevelHeadPathCompress(HM_chunk chunk) {
     cursor = representative;
   }
 
+  writeLevelHeadCache(chunk, levelHead);
   return levelHead;
 }
 
@@ -689,6 +759,7 @@ void HM_deleteChunks(GC_state s, HM_chunkList deleteList) {
     HM_chunk c = chunk;
     chunk = chunk->nextChunk;
     HM_unlinkChunk(deleteList, c);
+    S_removeHeapOccupancy(s, HM_getChunkSize(c));
     GC_release (c, HM_getChunkSize(c));
   }
   unlockSharedList(s);
@@ -791,5 +862,6 @@ uint32_t HM_getObjptrDepth(objptr op) {
 }
 
 uint32_t HM_getObjptrDepthPathCompress(objptr op) {
-  return HM_getLevelHeadPathCompress(HM_getChunkOf(objptrToPointer(op, NULL)))->depth;
+  HM_chunk chunk = HM_getChunkOf(objptrToPointer(op, NULL));
+  return HM_getLevelHeadPathCompress(chunk)->depth;
 }
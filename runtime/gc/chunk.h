@@ -19,11 +19,16 @@ typedef struct HM_chunkList * HM_chunkList;
 /* SAM_NOTE: Why do I need to declare here? Shouldn't the forwarding functions
  * be in hierarchical-heap-collection.{c,h}? */
 struct ForwardHHObjptrArgs;
+struct HP_sample;
 
 #define CHUNK_INVALID_DEPTH (~((uint32_t)(0)))
 
 #define CHUNK_MAGIC 0xcafeface
 
+/* The first block of each chunk is divided into this many lines, which are
+ * the granularity at which concurrent collection tracks live data. */
+#define HM_LINES_PER_BLOCK 64
+
 /* Chunks are contiguous regions of memory for containing heap-allocated user
  * (ML) objects. Metadata which is common across all objects within a chunk
  * are stored in this struct, at the front of the chunk. Each chunk metadata
@@ -45,6 +50,16 @@ struct ForwardHHObjptrArgs;
 struct HM_chunk {
   struct HM_UnionFindNode *levelHead;
 
+  /* The representative of levelHead, as last found by
+   * HM_getLevelHeadPathCompress, so that lookups usually go straight from
+   * this header to the heap record. Valid while levelHeadTag equals the
+   * cacheTag of cachedLevelHead, which a heap loses when it is linked into
+   * another (see chunk.c). 0 means nothing is cached, and
+   * HM_LEVEL_HEAD_CACHE_BUSY that the cache is being written. Change
+   * levelHead with HM_setLevelHead, which drops the cache. */
+  uint64_t levelHeadTag;
+  struct HM_HierarchicalHeap *cachedLevelHead;
+
   pointer frontier; // end of allocations within this chunk
   pointer limit;    // the end of this chunk
 
@@ -63,8 +78,33 @@ struct HM_chunk {
   uint8_t startGap;
 
   bool mightContainMultipleObjects;
+
+  /* Set by a compacting local collection for chunks dense enough to be kept
+   * where they are rather than evacuated; see HM_HHC_collectLocal. */
+  bool keepInPlace;
+
+  /* Survived a local collection of its leaf heap, which minor collections of
+   * that heap need not copy again. Only meaningful in s->nurseryLeaf. */
+  bool tenured;
   void* tmpHeap;
 
+  /* objects in this chunk sampled by the heap profiler; see heap-profile.h */
+  struct HP_sample *heapSamples;
+
+  /* Lines of the first block which hold live data, one bit per line, as
+   * found by the most recent concurrent collection of this chunk. Only
+   * meaningful during that collection; see concurrent-collection.c */
+  uint64_t liveLines;
+
+  /* Side mark bitmap for the first block, one bit per GC_HEADER_SIZE bytes,
+   * indexed by the offset of the object pointer. Allocated by a concurrent
+   * collection when it saves the chunk, and NULL otherwise. */
+  uint64_t *markBits;
+
+  /* Bytes of the objects marked in this chunk by the running compacting
+   * local collection. */
+  size_t localLiveBytes;
+
   // for padding and sanity checks
   uint32_t magic;
 
@@ -98,6 +138,7 @@ COMPILE_TIME_ASSERT(HM_chunk__aligned,
 // by HM_configChunks at program start.
 extern size_t HM_BLOCK_SIZE;
 extern size_t HM_ALLOC_SIZE;
+extern size_t HM_LINE_SIZE; /* HM_BLOCK_SIZE / HM_LINES_PER_BLOCK */
 
 // INLINE FUNCTIONS ==========================================================
 
@@ -113,6 +154,23 @@ static inline bool inFirstBlockOfChunk(HM_chunk chunk, pointer p) {
   return p < (pointer)chunk + HM_BLOCK_SIZE;
 }
 
+/* Index of the line of the first block of chunk containing p. Pointers past
+ * the first block count as being in its last line. */
+static inline uint32_t lineOf(HM_chunk chunk, pointer p) {
+  size_t offset = (size_t)(p - (pointer)chunk);
+  if (offset >= HM_BLOCK_SIZE)
+    return HM_LINES_PER_BLOCK - 1;
+  return (uint32_t)(offset / HM_LINE_SIZE);
+}
+
+#define HM_LEVEL_HEAD_CACHE_BUSY UINT64_MAX
+
+static inline void HM_setLevelHead(HM_chunk chunk,
+                                   struct HM_UnionFindNode *levelHead) {
+  chunk->levelHead = levelHead;
+  __atomic_store_n(&(chunk->levelHeadTag), 0, __ATOMIC_RELEASE);
+}
+
 /* Find the associated chunk metadata of a pointer which is known to point
  * into the first block of a chunk. */
 static inline HM_chunk HM_getChunkOf(pointer p) {
@@ -11,10 +11,17 @@
 #if (defined (MLTON_GC_INTERNAL_FUNCS))
 #define casCC(F, O, N) ((__sync_val_compare_and_swap(F, O, N)))
 
+static volatile uint64_t CC_started = 0;
+
 void forwardPtrChunk (GC_state s, objptr *opp, void* rawArgs);
 void saveChunk(HM_chunk chunk, ConcurrentCollectArgs* args);
+void markLiveLines(HM_chunk chunk, pointer start, pointer end);
 #define ASSERT2 0
 
+uint64_t CC_numStarted(void) {
+  return CC_started;
+}
+
 void CC_initStack(ConcurrentPackage cp) {
   // don't re-initialize
   if(cp->rootList!=NULL) {
@@ -50,8 +57,20 @@ void CC_freeStack(ConcurrentPackage cp) {
   }
 }
 
+// Marks live in a bitmap on the side (chunk->markBits) rather than in object
+// headers, so that marking doesn't dirty the objects or race with the
+// mutator reading their headers, and so that clearing them is just freeing
+// the bitmaps.
+static inline size_t markBitIndex(HM_chunk chunk, pointer p) {
+  assert(inFirstBlockOfChunk(chunk, p));
+  return (size_t)(p - (pointer)chunk) / GC_HEADER_SIZE;
+}
+
 bool CC_isPointerMarked (pointer p) {
-  return ((MARK_MASK & getHeader (p)) == MARK_MASK);
+  HM_chunk chunk = HM_getChunkOf(p);
+  assert(NULL != chunk->markBits);
+  size_t i = markBitIndex(chunk, p);
+  return (chunk->markBits[i / 64] >> (i % 64)) & 1;
 }
 
 /** Is it in the from space? */
@@ -82,6 +101,10 @@ pointer getTransitivePtr(pointer p, ConcurrentCollectArgs* args) {
     if(chunk->tmpHeap == args->fromHead){
       saveChunk(chunk, args);
     }
+    // Others may still follow the forwarding pointer, so keep its line.
+    if(chunk->tmpHeap == args->toHead) {
+      markLiveLines(chunk, p - GC_HEADER_SIZE, p);
+    }
     op = getFwdPtr(p);
     p = objptrToPointer(op, NULL);
   }
@@ -89,10 +112,48 @@ pointer getTransitivePtr(pointer p, ConcurrentCollectArgs* args) {
 }
 
 void markObj(pointer p) {
-  GC_header* headerp = getHeaderp(p);
-  GC_header header = *headerp;
-  header ^= MARK_MASK;
-  *headerp = header;
+  HM_chunk chunk = HM_getChunkOf(p);
+  assert(NULL != chunk->markBits);
+  size_t i = markBitIndex(chunk, p);
+  chunk->markBits[i / 64] |= (uint64_t)1 << (i % 64);
+}
+
+// Give a chunk which is being saved an empty mark bitmap, carved out of
+// args->markBitmaps.
+void allocateMarkBitmap(HM_chunk chunk, ConcurrentCollectArgs* args) {
+  size_t bytes = HM_BLOCK_SIZE / (8 * GC_HEADER_SIZE);
+  HM_chunk store = HM_getChunkListLastChunk(args->markBitmaps);
+  if (NULL == store || HM_getChunkSizePastFrontier(store) < bytes) {
+    store = HM_allocateChunk(args->markBitmaps, bytes);
+  }
+
+  pointer frontier = HM_getChunkFrontier(store);
+  HM_updateChunkFrontierInList(args->markBitmaps, store, frontier + bytes);
+  memset(frontier, 0, bytes);
+  chunk->markBits = (uint64_t*)frontier;
+}
+
+// Set the bits of chunk->liveLines for the lines that [start, end) overlaps.
+// Anything past the first block falls into the last line.
+void markLiveLines(HM_chunk chunk, pointer start, pointer end) {
+  assert(start < end);
+  uint32_t first = lineOf(chunk, start);
+  uint32_t last = lineOf(chunk, end - 1);
+  chunk->liveLines |=
+    (~(uint64_t)0 >> (HM_LINES_PER_BLOCK - 1 - last)) & (~(uint64_t)0 << first);
+}
+
+// Mark the lines of a (non-forwarded) object, if its chunk is being
+// collected. Returns the size of the object.
+size_t markObjectLines(GC_state s, pointer p, ConcurrentCollectArgs* args) {
+  size_t metaDataBytes, objectBytes;
+  sizeofObjectAux(s, p, &metaDataBytes, &objectBytes);
+
+  HM_chunk chunk = HM_getChunkOf(p);
+  if (isChunkSaved(chunk, args) || isInScope(chunk, args)) {
+    markLiveLines(chunk, p - metaDataBytes, p + objectBytes);
+  }
+  return metaDataBytes + objectBytes;
 }
 
 // This function is exactly the same as in chunk.c.
@@ -128,6 +189,7 @@ void saveChunk(HM_chunk chunk, ConcurrentCollectArgs* args) {
 
   assert(chunk->tmpHeap == args->fromHead);
   chunk->tmpHeap = args->toHead;
+  allocateMarkBitmap(chunk, args);
 
   HM_assertChunkListInvariants(args->origList);
   HM_assertChunkListInvariants(args->repList);
@@ -154,7 +216,8 @@ bool saveNoForward(
 void markAndScan(GC_state s, pointer p, void* rawArgs) {
   if(!CC_isPointerMarked(p)) {
     markObj(p);
-    ((ConcurrentCollectArgs*)rawArgs)->bytesSaved += sizeofObject(s, p);
+    ((ConcurrentCollectArgs*)rawArgs)->bytesSaved +=
+      markObjectLines(s, p, rawArgs);
     assert(CC_isPointerMarked(p));
 
     struct GC_foreachObjptrClosure forwardPtrClosure =
@@ -238,41 +301,24 @@ void forwardDownPtrChunk(GC_state s, __attribute__((unused)) objptr dst,
   // forwardPtrChunk(s, &dst, rawArgs);
 }
 
-void unmarkPtrChunk(GC_state s, objptr* opp, void* rawArgs) {
-  objptr op = *opp;
-  assert(isObjptr(op));
-
-  pointer p = objptrToPointer (op, NULL);
-  HM_chunk chunk = HM_getChunkOf(p);
-
-  // check that getTransitivePtr can be called.
-  if (!isChunkSaved(chunk, rawArgs)) {
-    return;
-  }
-  p = getTransitivePtr(p, rawArgs);
-
-  if(CC_isPointerMarked (p)) {
-    assert(chunk->tmpHeap == ((ConcurrentCollectArgs*)rawArgs)->toHead);
-    markObj(p);
-
-    assert(!CC_isPointerMarked(p));
-
-    struct GC_foreachObjptrClosure unmarkPtrClosure =
-    {.fun = unmarkPtrChunk, .env = rawArgs};
-    foreachObjptrInObject(s, p, &trueObjptrPredicateClosure,
-            &unmarkPtrClosure, FALSE);
-  }
-}
-
-void unmarkDownPtrChunk(
+// The remembered set keeps referring to dst, so its lines must survive
+// along with its chunk.
+void markDownPtrDstLines(
   GC_state s,
   objptr dst,
   __attribute__((unused)) objptr* field,
-  objptr src,
+  __attribute__((unused)) objptr src,
   void* rawArgs)
 {
-  unmarkPtrChunk(s, &src, rawArgs);
-  unmarkPtrChunk(s, &dst, rawArgs);
+  pointer p = objptrToPointer(dst, NULL);
+  HM_chunk chunk = HM_getChunkOf(p);
+  if (isChunkSaved(chunk, rawArgs)) {
+    if (hasFwdPtr(p)) {
+      markLiveLines(chunk, p - GC_HEADER_SIZE, p);
+    } else {
+      markObjectLines(s, p, rawArgs);
+    }
+  }
 }
 
 // This function does more than forwardPtrChunk.
@@ -286,7 +332,8 @@ void forceForward(GC_state s, objptr *opp, void* rawArgs) {
   if(saved && !CC_isPointerMarked(p)) {
     assert(getTransitivePtr(p, rawArgs) == p);
     markObj(p);
-    ((ConcurrentCollectArgs*)rawArgs)->bytesSaved += sizeofObject(s, p);
+    ((ConcurrentCollectArgs*)rawArgs)->bytesSaved +=
+      markObjectLines(s, p, rawArgs);
   }
 
   struct GC_foreachObjptrClosure forwardPtrClosure =
@@ -295,18 +342,6 @@ void forceForward(GC_state s, objptr *opp, void* rawArgs) {
           &forwardPtrClosure, FALSE);
 }
 
-void forceUnmark (GC_state s, objptr* opp, void* rawArgs) {
-  pointer p = objptrToPointer(*opp, NULL);
-  if(CC_isPointerMarked(p)){
-    assert(getTransitivePtr(p, rawArgs) == p);
-    markObj(p);
-  }
-  struct GC_foreachObjptrClosure unmarkPtrClosure =
-  {.fun = unmarkPtrChunk, .env = rawArgs};
-  foreachObjptrInObject(s, p, &trueObjptrPredicateClosure,
-          &unmarkPtrClosure, FALSE);
-}
-
 void ensureCallSanity(
   __attribute__((unused)) GC_state s,
   ARG_USED_FOR_ASSERT HM_HierarchicalHeap targetHH,
@@ -372,15 +407,7 @@ bool claimHeap(HM_HierarchicalHeap heap) {
   return TRUE;
 }
 
-void CC_collectAtRoot(pointer threadp, pointer hhp) {
-  GC_state s = pthread_getspecific (gcstate_key);
-  GC_thread thread = threadObjptrToStruct(s, pointerToObjptr(threadp, NULL));
-  HM_HierarchicalHeap heap = (HM_HierarchicalHeap)hhp;
-
-  if (!checkLocalScheduler(s) || thread->currentDepth<=0) {
-    return;
-  }
-
+void collectRootHeap(GC_state s, GC_thread thread, HM_HierarchicalHeap heap) {
   if (!claimHeap(heap)) {
     return;
   }
@@ -390,8 +417,10 @@ void CC_collectAtRoot(pointer threadp, pointer hhp) {
   s->amInCC = TRUE;
 
   size_t beforeSize = HM_getChunkListSize(HM_HH_getChunkList(heap));
+  Trace2(EVENT_CC_ROOT_ENTER, (EventInt)heap, beforeSize);
   size_t live = CC_collectWithRoots(s, heap, thread);
   size_t afterSize = HM_getChunkListSize(HM_HH_getChunkList(heap));
+  Trace2(EVENT_CC_ROOT_LEAVE, afterSize, live);
 
   size_t diff = beforeSize > afterSize ? beforeSize - afterSize : 0;
 
@@ -403,10 +432,111 @@ void CC_collectAtRoot(pointer threadp, pointer hhp) {
     live,
     100.0 * (1.0 - (double)live / (double)afterSize));
 
-  HM_HH_getConcurrentPack(heap)->ccstate = CC_UNREG;
+  /* release: the owner may take chunks of the heap (CC_recycleRootChunk) as
+   * soon as it sees CC_UNREG */
+  __atomic_store_n(&(HM_HH_getConcurrentPack(heap)->ccstate), CC_UNREG,
+                   __ATOMIC_RELEASE);
   s->amInCC = FALSE;
 }
 
+void CC_collectAtRoot(pointer threadp, pointer hhp) {
+  GC_state s = pthread_getspecific (gcstate_key);
+  GC_thread thread = threadObjptrToStruct(s, pointerToObjptr(threadp, NULL));
+  HM_HierarchicalHeap heap = (HM_HierarchicalHeap)hhp;
+
+  // With dedicated gc threads, the heap was handed to them when it was
+  // registered, and the scheduler doesn't push a task for it.
+  if (s->controls->gcThreads > 0) {
+    return;
+  }
+
+  if (!checkLocalScheduler(s) || thread->currentDepth<=0) {
+    return;
+  }
+
+  collectRootHeap(s, thread, heap);
+}
+
+/* Root collections waiting for a gc thread. There is at most one per root
+ * heap, because a heap is registered again only after its collection. */
+struct CC_rootRequest {
+  GC_thread thread;
+  HM_HierarchicalHeap heap;
+  struct CC_rootRequest *next;
+};
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t nonEmpty;
+  struct CC_rootRequest *first;
+  struct CC_rootRequest *last;
+} CC_rootRequests = {
+  PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER,
+  NULL,
+  NULL
+};
+
+void CC_requestRootCollection(GC_thread thread, HM_HierarchicalHeap heap) {
+  struct CC_rootRequest *request = malloc_safe(sizeof(struct CC_rootRequest));
+  request->thread = thread;
+  request->heap = heap;
+  request->next = NULL;
+
+  pthread_mutex_lock(&CC_rootRequests.lock);
+  if (NULL == CC_rootRequests.last) {
+    CC_rootRequests.first = request;
+  } else {
+    CC_rootRequests.last->next = request;
+  }
+  CC_rootRequests.last = request;
+  pthread_cond_signal(&CC_rootRequests.nonEmpty);
+  pthread_mutex_unlock(&CC_rootRequests.lock);
+}
+
+void* CC_gcThreadLoop(void* arg) {
+  GC_state s = (GC_state)arg;
+  uint32_t k = (uint32_t)Proc_processorNumber(s) - s->numberOfProcs;
+
+  pthread_setspecific(gcstate_key, s);
+  if (s->controls->gcAffinityBase >= 0) {
+    set_cpu_affinity(s->controls->gcAffinityBase + k);
+  }
+
+  // All of our time is spent in CC, and we hold no HH records while idle.
+  s->profiling.phase = PROFILE_PHASE_CC;
+  HH_EBR_enterQuiescentState(s);
+
+  while (TRUE) {
+    pthread_mutex_lock(&CC_rootRequests.lock);
+    while (NULL == CC_rootRequests.first) {
+      pthread_cond_wait(&CC_rootRequests.nonEmpty, &CC_rootRequests.lock);
+    }
+    struct CC_rootRequest *request = CC_rootRequests.first;
+    CC_rootRequests.first = request->next;
+    if (NULL == CC_rootRequests.first) {
+      CC_rootRequests.last = NULL;
+    }
+    pthread_mutex_unlock(&CC_rootRequests.lock);
+
+    LOG(LM_CC_COLLECTION, LL_DEBUG,
+        "gc thread %u collecting root heap %p",
+        k, (void*)request->heap);
+    collectRootHeap(s, request->thread, request->heap);
+    HH_EBR_enterQuiescentState(s);
+
+    /* Nothing else ever allocates out of this state's free lists, so hand
+     * the chunks freed by the collection over to the mutators. */
+    HM_appendToSharedList(s, getFreeListSmall(s));
+    HM_initChunkList(getFreeListSmall(s));
+    HM_appendToSharedList(s, getFreeListLarge(s));
+    HM_initChunkList(getFreeListLarge(s));
+    free(request);
+  }
+
+  return NULL;
+}
+
 uint32_t minPrivateLevel(GC_state s) {
   uint64_t topval = *(uint64_t*)objptrToPointer(s->wsQueueTop, NULL);
   uint32_t shallowestPrivateLevel = UNPACK_IDX(topval);
@@ -431,15 +561,80 @@ void CC_collectAtPublicLevel(GC_state s, GC_thread thread, uint32_t depth) {
   }
 
   // collect only if the heap is above a threshold size
-  if (HM_getChunkListSize(&(heap->chunkList)) >= 2 * HM_BLOCK_SIZE) {
+  size_t beforeSize = HM_getChunkListSize(&(heap->chunkList));
+  if (beforeSize >= 2 * HM_BLOCK_SIZE) {
     assert(getThreadCurrent(s) == thread);
-    CC_collectWithRoots(s, heap, thread);
+    Trace3(EVENT_CC_INTERNAL_ENTER, (EventInt)heap, beforeSize, depth);
+    size_t live = CC_collectWithRoots(s, heap, thread);
+    Trace2(EVENT_CC_INTERNAL_LEAVE,
+           HM_getChunkListSize(&(heap->chunkList)), live);
   }
 
   // Mark that collection is complete
   HM_HH_getConcurrentPack(heap)->ccstate = CC_UNREG;
 }
 
+static inline uint64_t timespecToNanos(struct timespec *t) {
+  return (uint64_t)t->tv_sec * 1000000000ULL + (uint64_t)t->tv_nsec;
+}
+
+void CC_collectPublicLevels(GC_state s, GC_thread thread, uint32_t desiredScope) {
+  uint64_t budget = 1000ULL * s->controls->hhConfig.internalCCLevelBudget;
+
+  if (0 == budget) {
+    for (uint32_t i = 2; i < desiredScope; i++) {
+      CC_collectAtPublicLevel(s, thread, i);
+    }
+    return;
+  }
+
+  if (desiredScope <= 2) {
+    return;
+  }
+
+  // Estimate the cost of collecting a level from its size, using the rate
+  // of the internal CCs so far.
+  struct GC_cumulativeStatistics *stats = s->cumulativeStatistics;
+  uint64_t pastNanos = timespecToNanos(&(stats->timeInternalCC));
+  uint64_t pastBytes =
+    stats->bytesReclaimedByInternalCC + stats->bytesRetainedByInternalCC;
+  double nanosPerByte =
+    (0 == pastBytes) ? 0.0 : (double)pastNanos / (double)pastBytes;
+
+  struct timespec startTime;
+  struct timespec now;
+  timespec_now(&startTime);
+
+  uint32_t numLevels = desiredScope - 2;
+  uint32_t depth = s->nextInternalCCDepth;
+  if (depth < 2 || depth >= desiredScope) {
+    depth = 2;
+  }
+
+  for (uint32_t n = 0; n < numLevels; n++) {
+    timespec_now(&now);
+    timespec_sub(&now, &startTime);
+    uint64_t elapsed = timespecToNanos(&now);
+    if (elapsed >= budget) {
+      break;
+    }
+
+    HM_HierarchicalHeap heap = findHeap(thread, depth);
+    if (n > 0 && NULL != heap) {
+      double estimate =
+        nanosPerByte * (double)HM_getChunkListSize(HM_HH_getChunkList(heap));
+      if (estimate > (double)(budget - elapsed)) {
+        break;
+      }
+    }
+
+    CC_collectAtPublicLevel(s, thread, depth);
+    depth = (depth + 1 < desiredScope) ? depth + 1 : 2;
+  }
+
+  s->nextInternalCCDepth = depth;
+}
+
 void CC_filterDownPointers(GC_state s, HM_chunkList x, HM_HierarchicalHeap hh){
   /** There is no race here, because for truly concurrent GC (depth 1), the
     * hh has been split.
@@ -454,12 +649,146 @@ void CC_filterDownPointers(GC_state s, HM_chunkList x, HM_HierarchicalHeap hh){
   *y = *x;
 }
 
+// Give back the dead tail of each surviving chunk: move its frontier back to
+// the end of its last live line, and move any blocks past the first which
+// are then entirely free to origList, to be freed with the dead chunks.
+// This is tail trimming only: free lines between live ones stay where they
+// are, unused. Returns their bytes.
+size_t trimDeadTails(GC_state s, GC_thread thread,
+                     ConcurrentCollectArgs* args) {
+  size_t fragmented = 0;
+  HM_chunk chunk = HM_getChunkListFirstChunk(args->repList);
+
+  while (chunk != NULL) {
+    HM_chunk next = chunk->nextChunk;
+    uint64_t live = chunk->liveLines;
+
+    // The mutator may be bumping the frontier of its current chunk, and a
+    // chunk without any marked lines was saved for a reason we can't see.
+    if (!chunk->mightContainMultipleObjects
+        || chunk == thread->currentChunk
+        || live == 0) {
+      chunk = next;
+      continue;
+    }
+
+    uint32_t lastLive = HM_LINES_PER_BLOCK - 1 - __builtin_clzll(live);
+    if (lastLive < HM_LINES_PER_BLOCK - 1) {
+      pointer end = (pointer)chunk + (lastLive + 1) * HM_LINE_SIZE;
+      if (end < HM_getChunkFrontier(chunk)) {
+        if (HP_isEnabled(s))
+          HP_reclaimSamplesPast(s, chunk, end);
+        HM_updateChunkFrontierInList(args->repList, chunk, end);
+      }
+
+      // Nothing live reaches past the first block.
+      if (HM_getChunkSize(chunk) > HM_BLOCK_SIZE) {
+        HM_chunk tail = HM_splitChunk(args->repList, chunk,
+          HM_getChunkSize(chunk) - HM_BLOCK_SIZE - sizeof(struct HM_chunk));
+        if (tail != NULL) {
+          CC_HM_unlinkChunk(args->repList, tail);
+          tail->tmpHeap = args->fromHead;
+          HM_appendChunk(args->origList, tail);
+        }
+      }
+    }
+
+    uint32_t usedLines = lineOf(chunk, HM_getChunkFrontier(chunk) - 1) + 1;
+    uint64_t used = (usedLines == HM_LINES_PER_BLOCK)
+                    ? ~(uint64_t)0
+                    : (((uint64_t)1 << usedLines) - 1);
+    fragmented += __builtin_popcountll(used & ~live) * HM_LINE_SIZE;
+
+    chunk = next;
+  }
+
+  return fragmented;
+}
+
+bool CC_isRecyclableChunk(GC_state s, HM_chunk chunk, size_t bytesRequested) {
+  double threshold = s->controls->hhConfig.recycleThreshold;
+  size_t bytesFree = HM_getChunkSizePastFrontier(chunk);
+
+  return threshold > 0.0
+      && chunk->mightContainMultipleObjects
+      && HM_getChunkSize(chunk) == HM_BLOCK_SIZE
+      && bytesFree >= bytesRequested
+      && bytesFree >= GC_HEAP_LIMIT_SLOP
+      && (double)bytesFree >= threshold * (double)HM_BLOCK_SIZE;
+}
+
+// Move the chunks of repList which are worth recycling to its front, where
+// CC_recycleRootChunk looks for them.
+void moveRecyclableChunksToFront(GC_state s, HM_chunkList repList) {
+  struct HM_chunkList _recyclable;
+  HM_chunkList recyclable = &(_recyclable);
+  HM_initChunkList(recyclable);
+
+  HM_chunk chunk = HM_getChunkListFirstChunk(repList);
+  while (chunk != NULL) {
+    HM_chunk next = chunk->nextChunk;
+    if (CC_isRecyclableChunk(s, chunk, 0)) {
+      CC_HM_unlinkChunk(repList, chunk);
+      HM_appendChunk(recyclable, chunk);
+    }
+    chunk = next;
+  }
+
+  HM_appendChunkList(recyclable, repList);
+  *repList = *recyclable;
+}
+
+HM_chunk CC_recycleRootChunk(GC_state s, GC_thread thread,
+                             size_t bytesRequested) {
+  HM_HierarchicalHeap hh = thread->hierarchicalHeap;
+
+  // Objects of the root heap are read by every processor, so only its own
+  // chunks may be reused, and only while they stay out of local GC.
+  if (s->controls->hhConfig.recycleThreshold <= 0.0
+      || s->controls->hhConfig.minLocalDepth < 2
+      || thread->currentDepth != 1
+      || HM_HH_getDepth(hh) != 1
+      || NULL == hh->subHeapForRootCC) {
+    return NULL;
+  }
+
+  // Only the owner registers the heap, so once root CC has finished with it
+  // no one else can touch it until we fork again.
+  HM_HierarchicalHeap subhh = hh->subHeapForRootCC;
+  ConcurrentPackage cp = HM_HH_getConcurrentPack(subhh);
+  if (__atomic_load_n(&(cp->ccstate), __ATOMIC_ACQUIRE) != CC_UNREG) {
+    return NULL;
+  }
+
+  HM_chunkList list = HM_HH_getChunkList(subhh);
+  HM_chunk chunk = HM_getChunkListFirstChunk(list);
+  if (NULL == chunk || !CC_isRecyclableChunk(s, chunk, bytesRequested)) {
+    return NULL;
+  }
+
+  CC_HM_unlinkChunk(list, chunk);
+  HM_appendChunk(HM_HH_getChunkList(hh), chunk);
+  HM_setLevelHead(chunk, HM_HH_getUFNode(hh));
+
+  size_t bytesFree = HM_getChunkSizePastFrontier(chunk);
+  s->cumulativeStatistics->bytesAllocated += bytesFree;
+  s->cumulativeStatistics->bytesRecycledByRootCC += bytesFree;
+
+  LOG(LM_CC_COLLECTION, LL_DEBUG,
+      "recycled chunk %p with %zu free bytes",
+      (void*)chunk, bytesFree);
+
+  return chunk;
+}
+
 size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
                          GC_thread thread) {
   struct timespec startTime;
   struct timespec stopTime;
 
   timespec_now(&startTime);
+  GC_profilePhase savedPhase = s->profiling.phase;
+  setProfilePhase(s, PROFILE_PHASE_CC);
 
   assert(NULL == targetHH->subHeapForRootCC);
 
@@ -479,15 +808,20 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
 
   HM_assertChunkListInvariants(origList);
 
+  struct HM_chunkList _markBitmaps;
+  HM_initChunkList(&(_markBitmaps));
+
   ConcurrentCollectArgs lists = {
     .origList = origList,
     .repList  = repList,
     .toHead = (void*)repList,
     .fromHead = (void*) &(origList),
-    .bytesSaved = 0
+    .bytesSaved = 0,
+    .markBitmaps = &(_markBitmaps)
   };
 
   HH_EBR_enterQuiescentState(s);
+  __sync_fetch_and_add(&CC_started, (uint64_t)1);
 
   // JATIN_NOTE: Some HM_hierarchical objects in origList
   // might not be reachable from the mutator roots.
@@ -505,7 +839,10 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
 #endif
     assert(T->tmpHeap == NULL);
     T->tmpHeap = lists.fromHead;
-    T->levelHead = HM_HH_getUFNode(targetHH);
+    HM_setLevelHead(T, HM_HH_getUFNode(targetHH));
+    // the chunk header (and start gap) is always live
+    T->liveLines = 0;
+    markLiveLines(T, (pointer)T, HM_getChunkStart(T));
   }
 
   /** SAM_NOTE: This code is no longer needed, because HH objects are not
@@ -534,7 +871,16 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   forceForward(s, &(cp->snapLeft), &lists);
   forceForward(s, &(cp->snapRight), &lists);
   forceForward(s, &(cp->snapTemp), &lists);
-  forceForward(s, &(s->wsQueue), &lists);
+  if (s->wsQueue != BOGUS_OBJPTR) {
+    forceForward(s, &(s->wsQueue), &lists);
+  } else {
+    // A gc thread has no deque of its own; keep every processor's.
+    for (uint32_t p = 0; p < s->numberOfProcs; p++) {
+      if (s->procStates[p].wsQueue != BOGUS_OBJPTR) {
+        forceForward(s, &(s->procStates[p].wsQueue), &lists);
+      }
+    }
+  }
   forceForward(s, &(cp->stack), &lists);
 
   // JATIN_NOTE: This is important because the stack object of the thread we are collecting
@@ -543,6 +889,13 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   // Scanning the stack races with the thread using it.
   saveNoForward(s, (void*)(thread->stack), &lists);
   saveNoForward(s, (void*)thread, &lists);
+  // Neither is marked, so keep their chunks whole.
+  if (isChunkSaved(HM_getChunkOf((void*)(thread->stack)), &lists)) {
+    HM_getChunkOf((void*)(thread->stack))->liveLines = ~(uint64_t)0;
+  }
+  if (isChunkSaved(HM_getChunkOf((void*)thread), &lists)) {
+    HM_getChunkOf((void*)thread)->liveLines = ~(uint64_t)0;
+  }
   forEachObjptrinStack(s, cp->rootList, forwardPtrChunk, &lists);
 
 #if ASSERT
@@ -558,16 +911,9 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   }
 #endif
 
-  struct HM_foreachDownptrClosure unmarkDownPtrChunkClosure =
-  {.fun = unmarkDownPtrChunk, .env = &lists};
-  HM_foreachRemembered(s, &downPtrs, &unmarkDownPtrChunkClosure);
-
-  forceUnmark(s, &(cp->snapLeft), &lists);
-  forceUnmark(s, &(cp->snapRight), &lists);
-  forceUnmark(s, &(cp->snapTemp), &lists);
-  forceUnmark(s, &(s->wsQueue), &lists);
-  forceUnmark(s, &(cp->stack), &lists);
-  forEachObjptrinStack(s, cp->rootList, unmarkPtrChunk, &lists);
+  struct HM_foreachDownptrClosure markDownPtrDstLinesClosure =
+  {.fun = markDownPtrDstLines, .env = &lists};
+  HM_foreachRemembered(s, &downPtrs, &markDownPtrDstLinesClosure);
 
 #if ASSERT2 // just contains code that is sometimes useful for debugging.
   HM_assertChunkListInvariants(origList);
@@ -615,6 +961,10 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   }
 #endif
 
+  size_t bytesFragmented = trimDeadTails(s, thread, &lists);
+  if (isConcurrent)
+    moveRecyclableChunksToFront(s, repList);
+
   uint64_t bytesSaved =  HM_getChunkListSize(repList);
   uint64_t bytesScanned =  HM_getChunkListSize(repList)
                           + HM_getChunkListSize(origList);
@@ -622,6 +972,11 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   cp->bytesSurvivedLastCollection = bytesSaved;
   cp->bytesAllocatedSinceLastCollection = 0;
 
+  /* nothing in the chunks left in origList survived, including any objects
+   * sampled by the heap profiler */
+  if (HP_isEnabled(s))
+    HP_reclaimSamples(s, origList, TRUE);
+
   struct HM_chunkList _deleteList;
   HM_chunkList deleteList = &(_deleteList);
   HM_initChunkList(deleteList);
@@ -629,7 +984,7 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   HM_chunk chunk = HM_getChunkListFirstChunk(origList);
   while (chunk!=NULL) {
     HM_chunk tChunk = chunk->nextChunk;
-    chunk->levelHead = NULL;
+    HM_setLevelHead(chunk, NULL);
     chunk->tmpHeap  = NULL;
     if(HM_getChunkSize(chunk) > 2 * (HM_BLOCK_SIZE)) {
       HM_unlinkChunk(origList, chunk);
@@ -644,7 +999,9 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
   for(HM_chunk chunk = repList->firstChunk;
     chunk!=NULL; chunk = chunk->nextChunk) {
     chunk->tmpHeap = NULL;
+    chunk->markBits = NULL;
   }
+  HM_appendChunkList(getFreeListSmall(s), &(_markBitmaps));
 
   *(origList) = *(repList);
 
@@ -662,14 +1019,21 @@ size_t CC_collectWithRoots(GC_state s, HM_HierarchicalHeap targetHH,
 
   if (isConcurrent) {
     timespec_add(&(s->cumulativeStatistics->timeRootCC), &stopTime);
+    S_recordPause(s, GC_PAUSE_ROOT_CC, &stopTime);
     s->cumulativeStatistics->numRootCCs++;
     s->cumulativeStatistics->bytesReclaimedByRootCC += bytesScanned-bytesSaved;
+    s->cumulativeStatistics->bytesRetainedByRootCC += bytesSaved;
+    s->cumulativeStatistics->bytesFragmentedByRootCC += bytesFragmented;
   } else {
     timespec_add(&(s->cumulativeStatistics->timeInternalCC), &stopTime);
+    S_recordPause(s, GC_PAUSE_INTERNAL_CC, &stopTime);
     s->cumulativeStatistics->numInternalCCs++;
     s->cumulativeStatistics->bytesReclaimedByInternalCC += bytesScanned-bytesSaved;
+    s->cumulativeStatistics->bytesRetainedByInternalCC += bytesSaved;
+    s->cumulativeStatistics->bytesFragmentedByInternalCC += bytesFragmented;
   }
 
+  setProfilePhase(s, savedPhase);
   return lists.bytesSaved;
 
 }
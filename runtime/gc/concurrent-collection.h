@@ -26,6 +26,8 @@ typedef struct ConcurrentCollectArgs {
 	void* toHead;
 	void* fromHead;
   size_t bytesSaved;
+  /* storage for the mark bitmaps of saved chunks, freed at the end */
+  HM_chunkList markBitmaps;
 } ConcurrentCollectArgs;
 
 
@@ -74,13 +76,49 @@ typedef struct ConcurrentPackage *ConcurrentPackage;
 // Assume complete access in this function
 // This function constructs a HM_chunkList of reachable chunks without copying them
 // Then it adds the remaining chunks to the free list.
-// The collections here proceeds here at the chunk level of granularity. i.e if one obj
-// in the chunk is live then the whole chunk is. However, tracing is at the granularity of objects.
+// Chunks are kept or freed as a whole, but tracing also records which lines
+// (HM_LINES_PER_BLOCK per block) of each chunk hold live objects. The dead
+// tail of a kept chunk, past its last live line, is cut off: the frontier
+// moves back and any blocks left empty are freed. Free lines between live
+// ones are not reused; they are only counted as fragmentation in the
+// statistics.
+// Objects are marked in a side bitmap per saved chunk (chunk->markBits),
+// never in their headers, so there is no pass to clear the marks.
 // Objects in chunks that are preserved may point to chunks that are not. But such objects aren't
 // reachable.
 size_t CC_collectWithRoots(GC_state s, struct HM_HierarchicalHeap * targetHH, GC_thread thread);
 
 void CC_collectAtPublicLevel(GC_state s, GC_thread thread, uint32_t depth);
+
+// Collect the public levels of depth 2 up to (not including) desiredScope.
+// With `@mpl internal-cc-level-budget US`, don't start another level once US
+// microseconds have been spent, or if past collections suggest it would
+// overrun the budget; the next call picks up at that level. Each level that
+// is started is collected in full, so a single heap may take longer than US.
+void CC_collectPublicLevels(GC_state s, GC_thread thread, uint32_t desiredScope);
+
+// With `@mpl gc-threads N`, root collections are not run by the scheduler's
+// task but by N dedicated pthreads, each with a GC state of its own after
+// those of the processors. HM_HH_registerCont hands them each registered
+// root heap and tells the scheduler so, which then pushes no collection task.
+void CC_requestRootCollection(GC_thread thread, struct HM_HierarchicalHeap * heap);
+void* CC_gcThreadLoop(void* arg);
+
+// The number of collections CC_collectWithRoots has begun, on any processor
+// or gc-thread. A collection can free chunks which dead objects of deeper
+// heaps still point to, so a minor local collection, which scans the dead
+// objects of tenured chunks, requires that none began since the last
+// collection of its leaf heap.
+uint64_t CC_numStarted(void);
+
+// Root CC leaves the chunks of the root heap with plenty of free space past
+// their frontier (see hhConfig.recycleThreshold) at the front of its list.
+// When the depth-1 heap of `thread` needs a new chunk and no root CC is
+// registered or running, take the first of these instead, so that the
+// mutator fills the space left by dead objects. Returns NULL if there is no
+// such chunk with at least `bytesRequested` free.
+HM_chunk CC_recycleRootChunk(GC_state s, GC_thread thread, size_t bytesRequested);
+bool CC_isRecyclableChunk(GC_state s, HM_chunk chunk, size_t bytesRequested);
 void CC_addToStack(ConcurrentPackage cp, pointer p);
 void CC_initStack(ConcurrentPackage cp);
 
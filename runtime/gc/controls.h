@@ -34,6 +34,21 @@ struct HM_HierarchicalHeapConfig {
   /* the shallowest depth that will be claimed for a local
    * collection. */
   uint32_t minLocalDepth;
+
+  /* a chunk of the root heap which root CC leaves with at least this
+   * fraction of a block free past its frontier is handed back to the
+   * mutator for allocation at depth 1 (see CC_recycleRootChunk). 0
+   * disables recycling. */
+  double recycleThreshold;
+
+  /* the time (in microseconds) after which a GC point starts no more internal
+   * CCs of public levels; the remaining levels wait for the next GC point.
+   * A level in progress is not interrupted. 0 means no limit. */
+  uint32_t internalCCLevelBudget;
+
+  /* the number of minor collections of a leaf heap between full collections
+   * of it; see HM_HHC_collectLocal. 0 disables minor collections. */
+  uint32_t minorGCs;
 };
 
 enum GC_CollectionType {
@@ -43,6 +58,12 @@ enum GC_CollectionType {
   NONE
 };
 
+/* How a local collection reclaims space; see HM_HHC_collectLocal. */
+enum GC_LocalGCMode {
+  LOCAL_GC_COPY,
+  LOCAL_GC_COMPACT
+};
+
 enum SummaryFormat {
   HUMAN,
   JSON
@@ -58,13 +79,27 @@ struct GC_controls {
   bool setAffinity; /* whether or not to set processor affinity */
   int32_t affinityBase; /* First processor to use when setting affinity */
   int32_t affinityStride; /* Number of processors between first and second */
+  uint32_t gcThreads; /* Dedicated threads for root CC; 0 runs it as a task. */
+  int32_t gcAffinityBase; /* First processor for gc threads; -1 to not pin */
   struct GC_ratios ratios;
   struct HM_HierarchicalHeapConfig hhConfig;
   bool rusageMeasureGC;
+  /* Also write time profiles of local GC, promotion and CC, charged to the
+   * code that triggered them. */
+  bool profileSplitGC;
+  /* Count cycles, cache and TLB misses of each GC phase (perf-counters.h). */
+  bool perfCounters;
   bool summary; /* Print a summary of gc info when program exits. */
   enum SummaryFormat summaryFormat;
   FILE* summaryFile;
+  /* Milliseconds between statistics snapshots; 0 disables them. */
+  uint32_t statsInterval;
+  FILE* statsFile; /* Where snapshots are appended, one JSON object per line. */
+  /* Where the heap profile is written at exit; NULL disables heap profiling. */
+  FILE* heapProfileFile;
+  size_t heapProfileRate; /* Average bytes allocated between samples. */
   enum GC_CollectionType collectionType;
+  enum GC_LocalGCMode localGCMode;
   /* Size of the trace buffer */
   size_t traceBufferSize;
 };
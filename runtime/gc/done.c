@@ -74,6 +74,67 @@ static void displayHHAllocStats(FILE *out, GC_state s) {
 }
 
 
+static void displaySchedulerStatistics (FILE *out, struct GC_schedulerStatistics *sched) {
+  fprintf (out, "num steals: %s\n",
+           uintmaxToCommaString (sched->numSteals));
+  fprintf (out, "num failed steals: %s\n",
+           uintmaxToCommaString (sched->numFailedSteals));
+  fprintf (out, "num tasks executed: %s\n",
+           uintmaxToCommaString (sched->numTasksExecuted));
+  fprintf (out, "max deque depth: %s\n",
+           uintmaxToCommaString (sched->maxDequeDepth));
+  fprintf (out, "time to first steal: %s us\n",
+           uintmaxToCommaString (sched->firstStealNanoseconds / 1000));
+  fprintf (out, "idle time: %s ms\n",
+           uintmaxToCommaString (sched->idleNanoseconds / 1000000));
+  fprintf (out, "steals from proc:");
+  for (uint32_t p = 0; p < sched->numStealsFromProcLength; p++) {
+    fprintf (out, " %"PRIu64, sched->numStealsFromProc[p]);
+  }
+  fprintf (out, "\n");
+}
+
+static void displayPauseStatistics (FILE *out, struct GC_pauseHistogram *pauses) {
+  static const char* names[GC_PAUSE_KINDS] =
+    { "local GC", "promotion", "root CC", "internal CC" };
+
+  for (uint32_t k = 0; k < GC_PAUSE_KINDS; k++) {
+    struct GC_pauseHistogram *h = &(pauses[k]);
+    fprintf (out, "%s pauses: %s", names[k], uintmaxToCommaString (h->count));
+    fprintf (out, ", p50 %s us",
+             uintmaxToCommaString (S_pausePercentile (h, 0.5) / 1000));
+    fprintf (out, ", p99 %s us",
+             uintmaxToCommaString (S_pausePercentile (h, 0.99) / 1000));
+    fprintf (out, ", p999 %s us\n",
+             uintmaxToCommaString (S_pausePercentile (h, 0.999) / 1000));
+  }
+}
+
+/* Pauses across all processors, since tail latency is a global property. */
+static void mergeAllPauses (GC_state s, struct GC_pauseHistogram *pauses) {
+  memset (pauses, 0, GC_PAUSE_KINDS * sizeof (*pauses));
+  for (uint32_t proc = 0; proc < Proc_numberOfStates (s); proc++) {
+    for (uint32_t k = 0; k < GC_PAUSE_KINDS; k++) {
+      S_mergePauseHistogram (&(pauses[k]),
+        &(s->procStates[proc].cumulativeStatistics->pauses[k]));
+    }
+  }
+}
+
+/* Fragmentation is the fraction of the retained chunk space that is in free
+ * lines, i.e. between live objects. */
+static void displayCCStats (FILE *out, const char *name,
+                            uintmax_t reclaimed,
+                            uintmax_t retained,
+                            uintmax_t fragmented) {
+  fprintf (out, "%s bytes reclaimed: %s bytes\n",
+           name, uintmaxToCommaString (reclaimed));
+  fprintf (out, "%s bytes retained: %s bytes (%.1f%% fragmented)\n",
+           name, uintmaxToCommaString (retained),
+           (0 == retained) ?
+           0.0 : 100.0 * ((double) fragmented) / (double) retained);
+}
+
 static void displayCumulativeStatistics (FILE *out, struct GC_cumulativeStatistics *cumulativeStatistics) {
   struct rusage ru_total;
   uintmax_t totalTime;
@@ -134,6 +195,20 @@ static void displayCumulativeStatistics (FILE *out, struct GC_cumulativeStatisti
            uintmaxToCommaString (cumulativeStatistics->bytesAllocated));
   fprintf (out, "total bytes promoted: %s bytes\n",
            uintmaxToCommaString (cumulativeStatistics->bytesPromoted));
+  displayCCStats (out, "root CC",
+                  cumulativeStatistics->bytesReclaimedByRootCC,
+                  cumulativeStatistics->bytesRetainedByRootCC,
+                  cumulativeStatistics->bytesFragmentedByRootCC);
+  fprintf (out, "root CC bytes recycled: %s bytes\n",
+           uintmaxToCommaString (cumulativeStatistics->bytesRecycledByRootCC));
+  fprintf (out, "local GC stack bytes skipped: %s bytes\n",
+           uintmaxToCommaString (cumulativeStatistics->bytesStackScanSkipped));
+  fprintf (out, "local GC bytes kept in place: %s bytes\n",
+           uintmaxToCommaString (cumulativeStatistics->bytesKeptInPlaceByLocal));
+  displayCCStats (out, "internal CC",
+                  cumulativeStatistics->bytesReclaimedByInternalCC,
+                  cumulativeStatistics->bytesRetainedByInternalCC,
+                  cumulativeStatistics->bytesFragmentedByInternalCC);
   fprintf (out, "max global heap bytes live: %s bytes\n",
            uintmaxToCommaString (cumulativeStatistics->maxBytesLive));
   fprintf (out, "max global heap size: %s bytes\n",
@@ -160,6 +235,8 @@ static void displayCumulativeStatistics (FILE *out, struct GC_cumulativeStatisti
            uintmaxToCommaString (cumulativeStatistics->syncForHeap));
   fprintf (out, "sync misc: %s\n",
            uintmaxToCommaString (cumulativeStatistics->syncMisc));
+  displaySchedulerStatistics (out, &cumulativeStatistics->sched);
+  displayPauseStatistics (out, cumulativeStatistics->pauses);
 }
 
 static void displayCumulativeStatisticsJSON (FILE *out, GC_state s) {
@@ -179,7 +256,7 @@ static void displayCumulativeStatisticsJSON (FILE *out, GC_state s) {
       if (s->procStates) {
         /* print cumulativeStatistics for each processor, separated by commas */
         uint32_t proc;
-        for (proc = 0; proc < s->numberOfProcs - 1; proc++) {
+        for (proc = 0; proc < Proc_numberOfStates(s) - 1; proc++) {
           S_outputCumulativeStatisticsJSON(
               out, s->procStates[proc].cumulativeStatistics);
           fprintf(out, ", ");
@@ -205,6 +282,15 @@ static void displayCumulativeStatisticsJSON (FILE *out, GC_state s) {
 
     fprintf(out, ", ");
 
+    fprintf(out, "\"pauses\" : ");
+    if (s->procStates) {
+      static struct GC_pauseHistogram allPauses[GC_PAUSE_KINDS];
+      mergeAllPauses(s, allPauses);
+      S_outputPauseStatisticsJSON(out, allPauses);
+    } else {
+      S_outputPauseStatisticsJSON(out, s->cumulativeStatistics->pauses);
+    }
+
     // SAM_NOTE: TODO: removed for now; will need to replace with blocks statistics
     // fprintf(out,
     //         "\"maxChunkPoolOccupancy\" : %"PRIuMAX,
@@ -216,6 +302,12 @@ static void displayCumulativeStatisticsJSON (FILE *out, GC_state s) {
 
 void GC_done(GC_state s) {
   GC_PthreadAtExit(s);
+  TracingFlushAll();
+  if (s->controls->statsInterval > 0)
+    S_outputStatisticsSnapshotJSON(s);
+  HP_writeProfile(s);
+  HPC_done(s);
+  L_flushAllBinaryLogs(s);
 
   if (s->controls->summary) {
     if (HUMAN == s->controls->summaryFormat) {
@@ -224,7 +316,10 @@ void GC_done(GC_state s) {
               (s->controls->summaryFile,
                s->globalCumulativeStatistics);
       if (s->procStates) {
-        for (uint32_t proc = 0; proc < s->numberOfProcs; proc++) {
+        static struct GC_pauseHistogram allPauses[GC_PAUSE_KINDS];
+        mergeAllPauses (s, allPauses);
+        displayPauseStatistics (s->controls->summaryFile, allPauses);
+        for (uint32_t proc = 0; proc < Proc_numberOfStates (s); proc++) {
           fprintf (s->controls->summaryFile, "Thread [%d]::\n", proc);
           displayCumulativeStatistics
               (s->controls->summaryFile,
@@ -210,46 +210,19 @@ pointer foreachObjptrInObject (GC_state s, pointer p,
     p += alignWithExtra (s, dataBytes, GC_SEQUENCE_METADATA_SIZE);
   } else if (STACK_TAG == tag) {
     GC_stack stack;
-    pointer top, bottom;
-    unsigned int i;
-    GC_returnAddress returnAddress;
-    GC_frameInfo frameInfo;
-    GC_frameOffsets frameOffsets;
-
 
     stack = (GC_stack)p;
-    bottom = getStackBottom (s, stack);
-    top = getStackTop (s, stack);
     if (DEBUG) {
       fprintf (stderr, "  bottom = "FMTPTR"  top = "FMTPTR"\n",
-               (uintptr_t)bottom, (uintptr_t)top);
+               (uintptr_t)getStackBottom (s, stack),
+               (uintptr_t)getStackTop (s, stack));
     }
 
     if (skip) {
       goto STACK_DONE;
     }
 
-    assert (stack->used <= stack->reserved);
-    while (top > bottom) {
-      /* Invariant: top points just past a "return address". */
-      returnAddress = *((GC_returnAddress*)(top - GC_RETURNADDRESS_SIZE));
-      if (DEBUG) {
-        fprintf (stderr, "  top = "FMTPTR"  return address = "FMTRA"\n",
-                 (uintptr_t)top, returnAddress);
-      }
-      frameInfo = getFrameInfoFromReturnAddress (s, returnAddress);
-      frameOffsets = frameInfo->offsets; // index zero of this array is size
-      top -= frameInfo->size;
-      for (i = 0 ; i < frameOffsets[0] ; ++i) {
-        if (DEBUG) {
-          fprintf(stderr, "  offset %"PRIx16"  address "FMTOBJPTR"\n",
-                  frameOffsets[i + 1], *(objptr*)(top + frameOffsets[i + 1]));
-        }
-
-        callIfIsObjptr (s, f, ((objptr*)(top + frameOffsets[i + 1])));
-      }
-    }
-    assert(top == bottom);
+    foreachObjptrInStackFrom (s, p, 0, f);
 
  STACK_DONE:
     p += sizeof (struct GC_stack) + stack->reserved;
@@ -261,6 +234,49 @@ DONE:
   return p;
 }
 
+/* foreachObjptrInStackFrom (s, p, offset, f)
+ *
+ * Applies f to each object pointer in the frames of the stack pointed to by
+ * p which begin at least offset bytes above its bottom. The offset must be a
+ * frame boundary.
+ */
+void foreachObjptrInStackFrom (GC_state s, pointer p, size_t offset,
+                               GC_foreachObjptrClosure f) {
+  GC_stack stack = (GC_stack)p;
+  pointer top, bottom, limit;
+  unsigned int i;
+  GC_returnAddress returnAddress;
+  GC_frameInfo frameInfo;
+  GC_frameOffsets frameOffsets;
+
+  bottom = getStackBottom (s, stack);
+  top = getStackTop (s, stack);
+  limit = bottom + offset;
+
+  assert (stack->used <= stack->reserved);
+  assert (offset <= stack->used);
+  while (top > limit) {
+    /* Invariant: top points just past a "return address". */
+    returnAddress = *((GC_returnAddress*)(top - GC_RETURNADDRESS_SIZE));
+    if (DEBUG) {
+      fprintf (stderr, "  top = "FMTPTR"  return address = "FMTRA"\n",
+               (uintptr_t)top, returnAddress);
+    }
+    frameInfo = getFrameInfoFromReturnAddress (s, returnAddress);
+    frameOffsets = frameInfo->offsets; // index zero of this array is size
+    top -= frameInfo->size;
+    for (i = 0 ; i < frameOffsets[0] ; ++i) {
+      if (DEBUG) {
+        fprintf(stderr, "  offset %"PRIx16"  address "FMTOBJPTR"\n",
+                frameOffsets[i + 1], *(objptr*)(top + frameOffsets[i + 1]));
+      }
+
+      callIfIsObjptr (s, f, ((objptr*)(top + frameOffsets[i + 1])));
+    }
+  }
+  assert(top == limit);
+}
+
 /* foreachObjptrInRange (s, front, back, f, skipWeaks)
  *
  * Apply f to each pointer between front and *back, which should be a
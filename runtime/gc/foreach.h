@@ -43,6 +43,16 @@ static inline pointer foreachObjptrInObject (GC_state s, pointer p,
                                              GC_objptrPredicateClosure g,
                                              GC_foreachObjptrClosure f,
                                              bool skipWeaks);
+/* foreachObjptrInStackFrom (s, p, offset, f)
+ *
+ * Applies f to each object pointer in the frames of the stack pointed to by
+ * p which begin at
+ * least offset bytes above its bottom. The offset must be a frame boundary;
+ * 0 visits the whole stack.
+ */
+static inline void foreachObjptrInStackFrom (GC_state s, pointer p,
+                                             size_t offset,
+                                             GC_foreachObjptrClosure f);
 /* foreachObjptrInRange (s, front, back, f, skipWeaks)
  *
  * Apply f to each pointer between front and *back, which should be a
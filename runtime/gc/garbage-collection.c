@@ -56,7 +56,7 @@ void growStackCurrent(GC_state s) {
   }
   assert(stackSize < HM_getChunkSizePastFrontier(newChunk));
   newChunk->mightContainMultipleObjects = FALSE;
-  newChunk->levelHead = HM_HH_getUFNode(hh);
+  HM_setLevelHead(newChunk, HM_HH_getUFNode(hh));
 
   pointer frontier = HM_getChunkFrontier(newChunk);
   assert(frontier == HM_getChunkStart(newChunk));
@@ -210,6 +210,56 @@ uintmax_t GC_getPromoMillisecondsOfProc(GC_state s, uint32_t proc) {
   return (uintmax_t)t->tv_sec * 1000 + (uintmax_t)t->tv_nsec / 1000000;
 }
 
+pointer GC_getSchedulerStatisticsOfProc(GC_state s, uint32_t proc) {
+  return (pointer)&(s->procStates[proc].cumulativeStatistics->sched);
+}
+
+pointer GC_getSchedulerStealsFromProcOfProc(GC_state s, uint32_t proc) {
+  return (pointer)(s->procStates[proc].cumulativeStatistics->sched.numStealsFromProc);
+}
+
+uintmax_t GC_getNumStealsOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.numSteals;
+}
+
+uintmax_t GC_getNumFailedStealsOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.numFailedSteals;
+}
+
+uintmax_t GC_getNumTasksExecutedOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.numTasksExecuted;
+}
+
+uintmax_t GC_getMaxDequeDepthOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.maxDequeDepth;
+}
+
+uintmax_t GC_getFirstStealNanosecondsOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.firstStealNanoseconds;
+}
+
+uintmax_t GC_getIdleNanosecondsOfProc(GC_state s, uint32_t proc) {
+  return s->procStates[proc].cumulativeStatistics->sched.idleNanoseconds;
+}
+
+uintmax_t GC_getIdleHistogramBucketOfProc(GC_state s, uint32_t proc, uint32_t bucket) {
+  assert(bucket < GC_SCHED_IDLE_BUCKETS);
+  return s->procStates[proc].cumulativeStatistics->sched.idleHistogram[bucket];
+}
+
+uintmax_t GC_getNumStealsFromProcOfProc(GC_state s, uint32_t thief, uint32_t victim) {
+  struct GC_schedulerStatistics *sched =
+    &(s->procStates[thief].cumulativeStatistics->sched);
+  assert(victim < sched->numStealsFromProcLength);
+  return sched->numStealsFromProc[victim];
+}
+
+uintmax_t GC_getPauseHistogramBucketOfProc(GC_state s, uint32_t proc, uint32_t kind, uint32_t bucket) {
+  assert(kind < GC_PAUSE_KINDS);
+  assert(bucket < GC_PAUSE_BUCKETS);
+  return s->procStates[proc].cumulativeStatistics->pauses[kind].buckets[bucket];
+}
+
 __attribute__((noreturn))
 void GC_setHashConsDuringGC(__attribute__((unused)) GC_state s, __attribute__((unused)) bool b) {
   DIE("GC_setHashConsDuringGC unsupported");
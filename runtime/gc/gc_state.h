@@ -59,6 +59,15 @@ struct GC_state {
   uint32_t maxFrameSize;
   /* SAM_NOTE: can remove this */
   bool mutatorMarksCards;
+  /* The level where the next round of internal CCs starts; see
+   * CC_collectPublicLevels */
+  uint32_t nextInternalCCDepth;
+  /* The leaf heap whose tenured chunks a minor collection may keep, or NULL;
+   * see HM_HHC_collectLocal. */
+  struct HM_HierarchicalHeap *nurseryLeaf;
+  uint64_t nurseryCCEpoch; /* CC_numStarted() when nurseryLeaf was set */
+  uint64_t numHeapsCreated; /* by this processor; see HM_HH_new */
+  uint32_t minorGCsSinceMajor;
   /* The maximum amount of concurrency */
   uint32_t numberOfProcs;
   GC_objectType objectTypes; /* Array of object types. */
@@ -80,6 +89,7 @@ struct GC_state {
   struct GC_signalsInfo signalsInfo;
   struct GC_sourceMaps sourceMaps;
   pointer stackBottom; /* Bottom of stack in current thread. */
+  size_t stackWatermarks[GC_STACK_WATERMARK_DEPTHS]; /* See thread.h */
   pthread_t self; /* thread owning the GC_state */
   struct GC_staticHeaps staticHeaps;
   struct GC_sysvals sysvals;
@@ -87,6 +97,10 @@ struct GC_state {
   GC_weak weaks; /* Linked list of (live) weak pointers */
   char *worldFile;
   struct TracingContext *trace;
+  struct HP_sampler heapSampler;
+  struct HPC_counters perfCounters;
+  struct GC_census *census; /* The most recent census, if any. */
+  struct L_binaryLog *binaryLog; /* Created by the first binary LOG. */
   struct TLSObjects tlsObjects;
 };
 
@@ -141,6 +155,19 @@ PRIVATE uintmax_t GC_getInternalCCMillisecondsOfProc(GC_state s, uint32_t proc);
 PRIVATE uintmax_t GC_getRootCCBytesReclaimedOfProc(GC_state s, uint32_t proc);
 PRIVATE uintmax_t GC_getInternalCCBytesReclaimedOfProc(GC_state s, uint32_t proc);
 
+PRIVATE pointer GC_getSchedulerStatisticsOfProc(GC_state s, uint32_t proc);
+PRIVATE pointer GC_getSchedulerStealsFromProcOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getNumStealsOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getNumFailedStealsOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getNumTasksExecutedOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getMaxDequeDepthOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getFirstStealNanosecondsOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getIdleNanosecondsOfProc(GC_state s, uint32_t proc);
+PRIVATE uintmax_t GC_getIdleHistogramBucketOfProc(GC_state s, uint32_t proc, uint32_t bucket);
+PRIVATE uintmax_t GC_getNumStealsFromProcOfProc(GC_state s, uint32_t thief, uint32_t victim);
+
+PRIVATE uintmax_t GC_getPauseHistogramBucketOfProc(GC_state s, uint32_t proc, uint32_t kind, uint32_t bucket);
+
 PRIVATE pointer GC_getCallFromCHandlerThread (GC_state s);
 PRIVATE void GC_setCallFromCHandlerThreads (GC_state s, pointer p);
 PRIVATE pointer GC_getCurrentThread (GC_state s);
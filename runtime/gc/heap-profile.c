@@ -0,0 +1,576 @@
+#if (defined (MLTON_GC_INTERNAL_FUNCS))
+
+#define HP_SITE_BUCKETS 4096
+
+/* Sites are looked up only when a sample is taken, so a single lock is
+ * plenty. */
+static pthread_mutex_t HP_siteLock = PTHREAD_MUTEX_INITIALIZER;
+static HP_site HP_sites[HP_SITE_BUCKETS];
+
+bool HP_isEnabled(GC_state s) {
+  return NULL != s->controls->heapProfileFile;
+}
+
+/* ========================================================================= */
+
+/* The distance to the next sample is drawn uniformly from
+ * [rate/2, 3*rate/2), so that sampling does not fall into lockstep with a
+ * regular allocation pattern. */
+static int64_t nextSampleInterval(GC_state s) {
+  struct HP_sampler *hp = &(s->heapSampler);
+  uint64_t rate = s->controls->heapProfileRate;
+
+  if (0 == hp->random)
+    hp->random = 0x9E3779B97F4A7C15ULL * ((uint64_t)s->procNumber + 1);
+
+  /* xorshift64 */
+  uint64_t x = hp->random;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  hp->random = x;
+
+  return (int64_t)(rate / 2 + x % rate);
+}
+
+static HP_site findSite(uint32_t depth,
+                        uint32_t numFrames,
+                        GC_frameIndex *frames)
+{
+  /* FNV-1a */
+  uint64_t hash = 14695981039346656037ULL ^ depth;
+  for (uint32_t i = 0; i < numFrames; i++)
+    hash = (hash ^ frames[i]) * 1099511628211ULL;
+  size_t bucket = (size_t)(hash ^ (hash >> 32)) % HP_SITE_BUCKETS;
+
+  pthread_mutex_lock(&HP_siteLock);
+
+  HP_site site;
+  for (site = HP_sites[bucket]; NULL != site; site = site->next) {
+    if (site->depth == depth &&
+        site->numFrames == numFrames &&
+        0 == memcmp(site->frames, frames, numFrames * sizeof(GC_frameIndex)))
+      break;
+  }
+
+  if (NULL == site) {
+    site = calloc(1, sizeof(struct HP_site));
+    if (NULL == site)
+      DIE("Out of memory for heap profile sites.");
+    site->depth = depth;
+    site->numFrames = numFrames;
+    memcpy(site->frames, frames, numFrames * sizeof(GC_frameIndex));
+    site->next = HP_sites[bucket];
+    HP_sites[bucket] = site;
+  }
+
+  pthread_mutex_unlock(&HP_siteLock);
+  return site;
+}
+
+void HP_sampleAllocation(GC_state s, HM_chunk chunk, pointer start, size_t bytes) {
+  struct HP_sampler *hp = &(s->heapSampler);
+
+  if (0 == hp->random)
+    hp->bytesUntilSample = nextSampleInterval(s);
+
+  hp->bytesSinceSample += bytes;
+  hp->bytesUntilSample -= (int64_t)bytes;
+  if (hp->bytesUntilSample > 0)
+    return;
+  hp->bytesUntilSample = nextSampleInterval(s);
+  uint64_t representedBytes = hp->bytesSinceSample;
+  hp->bytesSinceSample = 0;
+
+  /* Like foreachStackFrame, but stops after HP_MAX_FRAMES. */
+  GC_frameIndex frames[HP_MAX_FRAMES];
+  uint32_t numFrames = 0;
+  pointer bottom = getStackBottom(s, getStackCurrent(s));
+  pointer top = s->stackTop;
+  while (top > bottom && numFrames < HP_MAX_FRAMES) {
+    GC_returnAddress returnAddress =
+      *((GC_returnAddress*)(top - GC_RETURNADDRESS_SIZE));
+    GC_frameIndex frameIndex =
+      getFrameIndexFromReturnAddress(s, returnAddress);
+    assert(frameIndex < s->frameInfosLength);
+    frames[numFrames++] = frameIndex;
+    top -= s->frameInfos[frameIndex].size;
+  }
+
+  uint32_t depth = HM_HH_getDepth(HM_getLevelHeadPathCompress(chunk));
+
+  HP_sample sample = malloc(sizeof(struct HP_sample));
+  if (NULL == sample)
+    DIE("Out of memory for heap profile samples.");
+  sample->site = findSite(depth, numFrames, frames);
+  sample->start = start;
+  sample->representedBytes = representedBytes;
+  sample->weightObjects = 0;
+  sample->weightBytes = 0;
+  sample->survived = FALSE;
+  sample->promoted = FALSE;
+  sample->next = chunk->heapSamples;
+  chunk->heapSamples = sample;
+}
+
+/* ========================================================================= */
+
+/* Each sample stands for the chunk bytes handed out since the previous one,
+ * i.e. about representedBytes/bytes objects like it. Objects larger than
+ * that stand only for themselves. */
+static void resolveSample(HP_sample sample, size_t bytes) {
+  uint64_t represented = sample->representedBytes;
+
+  assert(0 == sample->weightObjects);
+  assert(bytes > 0);
+
+  sample->weightObjects =
+    (bytes >= represented) ? 1 : (represented + bytes / 2) / bytes;
+  sample->weightBytes = sample->weightObjects * bytes;
+
+  __sync_fetch_and_add(&(sample->site->allocObjects), sample->weightObjects);
+  __sync_fetch_and_add(&(sample->site->allocBytes), sample->weightBytes);
+}
+
+void HP_resolveSamples(GC_state s, HM_chunk chunk, pointer frontier) {
+  for (HP_sample sample = chunk->heapSamples;
+       NULL != sample;
+       sample = sample->next)
+  {
+    if (0 == sample->weightObjects && sample->start < frontier) {
+      pointer p = advanceToObjectData(s, sample->start);
+      resolveSample(sample, sizeofObject(s, p));
+    }
+  }
+}
+
+void HP_moveSample(HM_chunk from, pointer start, HM_chunk to, pointer newStart) {
+  for (HP_sample *cursor = &(from->heapSamples);
+       NULL != *cursor;
+       cursor = &((*cursor)->next))
+  {
+    HP_sample sample = *cursor;
+    if (sample->start == start && 0 == sample->weightObjects) {
+      *cursor = sample->next;
+      sample->start = newStart;
+      sample->next = to->heapSamples;
+      to->heapSamples = sample;
+      return;
+    }
+  }
+}
+
+void HP_relocateSample(__attribute__ ((unused)) GC_state s,
+                       HM_chunk from,
+                       pointer start,
+                       HM_chunk to,
+                       pointer newStart,
+                       size_t bytes,
+                       uint32_t fromDepth,
+                       uint32_t toDepth)
+{
+  HP_sample *cursor = &(from->heapSamples);
+  while (NULL != *cursor && (*cursor)->start != start)
+    cursor = &((*cursor)->next);
+
+  HP_sample sample = *cursor;
+  if (NULL == sample)
+    return;
+
+  if (0 == sample->weightObjects)
+    resolveSample(sample, bytes);
+
+  sample->start = newStart;
+  if (from != to) {
+    *cursor = sample->next;
+    sample->next = to->heapSamples;
+    to->heapSamples = sample;
+  }
+
+  HP_site site = sample->site;
+  if (toDepth < fromDepth) {
+    if (!sample->promoted) {
+      sample->promoted = TRUE;
+      __sync_fetch_and_add(&(site->promotedObjects), sample->weightObjects);
+      __sync_fetch_and_add(&(site->promotedBytes), sample->weightBytes);
+    }
+  } else if (!sample->survived) {
+    sample->survived = TRUE;
+    __sync_fetch_and_add(&(site->survivedObjects), sample->weightObjects);
+    __sync_fetch_and_add(&(site->survivedBytes), sample->weightBytes);
+  }
+}
+
+/* Anything the collector did not relocate out of these chunks is garbage,
+ * and its header is still intact, so unresolved samples can be sized here. */
+static void reclaimSample(GC_state s, HM_chunk chunk, HP_sample sample, bool byCC) {
+  if (0 == sample->weightObjects &&
+      sample->start < HM_getChunkFrontier(chunk))
+  {
+    pointer p = advanceToObjectData(s, sample->start);
+    resolveSample(sample, sizeofObject(s, p));
+  }
+
+  if (0 != sample->weightObjects) {
+    HP_site site = sample->site;
+    if (byCC) {
+      __sync_fetch_and_add(&(site->ccReclaimedObjects), sample->weightObjects);
+      __sync_fetch_and_add(&(site->ccReclaimedBytes), sample->weightBytes);
+    } else {
+      __sync_fetch_and_add(&(site->localReclaimedObjects), sample->weightObjects);
+      __sync_fetch_and_add(&(site->localReclaimedBytes), sample->weightBytes);
+    }
+  }
+
+  free(sample);
+}
+
+void HP_reclaimSamples(GC_state s, HM_chunkList list, bool byCC) {
+  for (HM_chunk chunk = HM_getChunkListFirstChunk(list);
+       NULL != chunk;
+       chunk = chunk->nextChunk)
+  {
+    HP_sample sample = chunk->heapSamples;
+    chunk->heapSamples = NULL;
+
+    while (NULL != sample) {
+      HP_sample next = sample->next;
+      reclaimSample(s, chunk, sample, byCC);
+      sample = next;
+    }
+  }
+}
+
+void HP_reclaimSamplesPast(GC_state s, HM_chunk chunk, pointer start) {
+  HP_sample *cursor = &(chunk->heapSamples);
+  while (NULL != *cursor) {
+    HP_sample sample = *cursor;
+    if (sample->start >= start) {
+      *cursor = sample->next;
+      reclaimSample(s, chunk, sample, TRUE);
+    } else {
+      cursor = &(sample->next);
+    }
+  }
+}
+
+void HP_reclaimSampleAt(GC_state s, HM_chunk chunk, pointer start) {
+  HP_sample *cursor = &(chunk->heapSamples);
+  while (NULL != *cursor && (*cursor)->start != start)
+    cursor = &((*cursor)->next);
+
+  HP_sample sample = *cursor;
+  if (NULL == sample)
+    return;
+
+  *cursor = sample->next;
+  reclaimSample(s, chunk, sample, FALSE);
+}
+
+void HP_discardSamples(HM_chunk chunk) {
+  HP_sample sample = chunk->heapSamples;
+  chunk->heapSamples = NULL;
+  while (NULL != sample) {
+    HP_sample next = sample->next;
+    free(sample);
+    sample = next;
+  }
+}
+
+/* ========================================================================= */
+/* pprof output                                                              */
+/* ========================================================================= */
+
+/* Just enough of a protocol buffer encoder to write profile.proto, see
+ * https://github.com/google/pprof/blob/main/proto/profile.proto */
+
+struct HP_buffer {
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+};
+
+static void bufferReserve(struct HP_buffer *b, size_t bytes) {
+  if (b->length + bytes <= b->capacity)
+    return;
+  b->capacity = max(2 * b->capacity, b->length + bytes);
+  b->data = realloc(b->data, b->capacity);
+  if (NULL == b->data)
+    DIE("Out of memory while writing heap profile.");
+}
+
+static void putVarint(struct HP_buffer *b, uint64_t x) {
+  bufferReserve(b, 10);
+  while (x >= 0x80) {
+    b->data[b->length++] = (uint8_t)(x | 0x80);
+    x >>= 7;
+  }
+  b->data[b->length++] = (uint8_t)x;
+}
+
+static void putUintField(struct HP_buffer *b, uint32_t field, uint64_t x) {
+  putVarint(b, ((uint64_t)field << 3) | 0);
+  putVarint(b, x);
+}
+
+static void putBytesField(struct HP_buffer *b,
+                          uint32_t field,
+                          const void *data,
+                          size_t length)
+{
+  putVarint(b, ((uint64_t)field << 3) | 2);
+  putVarint(b, length);
+  bufferReserve(b, length);
+  memcpy(b->data + b->length, data, length);
+  b->length += length;
+}
+
+/* Embed `m` as field `field` of `b`, and clear `m` for reuse. */
+static void putMessageField(struct HP_buffer *b,
+                            uint32_t field,
+                            struct HP_buffer *m)
+{
+  putBytesField(b, field, m->data, m->length);
+  m->length = 0;
+}
+
+/* The string table, with a hash index for interning. Index 0 is always the
+ * empty string. isFunction marks strings which are function names. */
+struct HP_strings {
+  char **strings;
+  bool *isFunction;
+  size_t length;
+  size_t capacity;
+  size_t *index; /* string index + 1, or 0 if empty */
+  size_t indexSize;
+};
+
+static uint64_t hashString(const char *str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (; '\0' != *str; str++)
+    hash = (hash ^ (uint8_t)*str) * 1099511628211ULL;
+  return hash;
+}
+
+static void growStringIndex(struct HP_strings *t) {
+  free(t->index);
+  t->indexSize = (0 == t->indexSize) ? 1024 : 2 * t->indexSize;
+  t->index = calloc(t->indexSize, sizeof(size_t));
+  if (NULL == t->index)
+    DIE("Out of memory while writing heap profile.");
+  for (size_t i = 0; i < t->length; i++) {
+    size_t slot = hashString(t->strings[i]) & (t->indexSize - 1);
+    while (0 != t->index[slot])
+      slot = (slot + 1) & (t->indexSize - 1);
+    t->index[slot] = i + 1;
+  }
+}
+
+static uint64_t internString(struct HP_strings *t, const char *str) {
+  if (2 * (t->length + 1) > t->indexSize)
+    growStringIndex(t);
+
+  size_t slot = hashString(str) & (t->indexSize - 1);
+  while (0 != t->index[slot]) {
+    if (0 == strcmp(t->strings[t->index[slot] - 1], str))
+      return t->index[slot] - 1;
+    slot = (slot + 1) & (t->indexSize - 1);
+  }
+
+  if (t->length == t->capacity) {
+    t->capacity = (0 == t->capacity) ? 256 : 2 * t->capacity;
+    t->strings = realloc(t->strings, t->capacity * sizeof(char *));
+    t->isFunction = realloc(t->isFunction, t->capacity * sizeof(bool));
+    if (NULL == t->strings || NULL == t->isFunction)
+      DIE("Out of memory while writing heap profile.");
+  }
+  t->strings[t->length] = strdup(str);
+  t->isFunction[t->length] = FALSE;
+  t->index[slot] = t->length + 1;
+  return t->length++;
+}
+
+static uint64_t internFunction(struct HP_strings *t, const char *name) {
+  uint64_t i = internString(t, name);
+  t->isFunction[i] = TRUE;
+  return i;
+}
+
+static void putValueType(struct HP_buffer *b,
+                         uint32_t field,
+                         struct HP_strings *strings,
+                         const char *type,
+                         const char *unit)
+{
+  struct HP_buffer m = {NULL, 0, 0};
+  putUintField(&m, 1, internString(strings, type));
+  putUintField(&m, 2, internString(strings, unit));
+  putMessageField(b, field, &m);
+  free(m.data);
+}
+
+/* The order of these must match the values written for each sample below. */
+static const char *HP_sampleTypes[][2] = {
+  {"alloc_objects", "count"},
+  {"alloc_space", "bytes"},
+  {"inuse_objects", "count"},
+  {"inuse_space", "bytes"},
+  {"survived_objects", "count"},
+  {"survived_space", "bytes"},
+  {"promoted_objects", "count"},
+  {"promoted_space", "bytes"},
+  {"local_reclaimed_objects", "count"},
+  {"local_reclaimed_space", "bytes"},
+  {"cc_reclaimed_objects", "count"},
+  {"cc_reclaimed_space", "bytes"},
+};
+
+void HP_writeProfile(GC_state s) {
+  if (!HP_isEnabled(s))
+    return;
+
+  /* The current chunk is the only one we own which might hold samples that
+   * have been allocated but never looked at. */
+  if (BOGUS_OBJPTR != s->currentThread) {
+    HM_chunk chunk = getThreadCurrent(s)->currentChunk;
+    if (NULL != chunk) {
+      pointer frontier = HM_getChunkFrontier(chunk);
+      if (HM_getChunkStart(chunk) <= s->frontier && s->frontier <= chunk->limit)
+        frontier = max(frontier, s->frontier);
+      HP_resolveSamples(s, chunk, frontier);
+    }
+  }
+
+  struct HP_strings strings = {NULL, NULL, 0, 0, NULL, 0};
+  struct HP_buffer profile = {NULL, 0, 0};
+  struct HP_buffer message = {NULL, 0, 0};
+  struct HP_buffer packed = {NULL, 0, 0};
+  struct HP_buffer label = {NULL, 0, 0};
+  struct HP_buffer line = {NULL, 0, 0};
+  bool *frameUsed = calloc(s->frameInfosLength, sizeof(bool));
+  if (NULL == frameUsed)
+    DIE("Out of memory while writing heap profile.");
+
+  internString(&strings, "");
+
+  for (size_t i = 0; i < sizeof(HP_sampleTypes) / sizeof(HP_sampleTypes[0]); i++)
+    putValueType(&profile, 1, &strings, HP_sampleTypes[i][0], HP_sampleTypes[i][1]);
+
+  uint64_t depthKey = internString(&strings, "depth");
+
+  pthread_mutex_lock(&HP_siteLock);
+  for (size_t b = 0; b < HP_SITE_BUCKETS; b++) {
+    for (HP_site site = HP_sites[b]; NULL != site; site = site->next) {
+      if (0 == site->allocObjects)
+        continue;
+
+      for (uint32_t i = 0; i < site->numFrames; i++) {
+        frameUsed[site->frames[i]] = TRUE;
+        putVarint(&packed, (uint64_t)site->frames[i] + 1);
+      }
+      putMessageField(&message, 1, &packed);
+
+      uint64_t reclaimedObjects =
+        site->localReclaimedObjects + site->ccReclaimedObjects;
+      uint64_t reclaimedBytes =
+        site->localReclaimedBytes + site->ccReclaimedBytes;
+      uint64_t values[] = {
+        site->allocObjects,
+        site->allocBytes,
+        site->allocObjects - min(site->allocObjects, reclaimedObjects),
+        site->allocBytes - min(site->allocBytes, reclaimedBytes),
+        site->survivedObjects,
+        site->survivedBytes,
+        site->promotedObjects,
+        site->promotedBytes,
+        site->localReclaimedObjects,
+        site->localReclaimedBytes,
+        site->ccReclaimedObjects,
+        site->ccReclaimedBytes
+      };
+      for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        putVarint(&packed, values[i]);
+      putMessageField(&message, 2, &packed);
+
+      putUintField(&label, 1, depthKey);
+      putUintField(&label, 3, site->depth);
+      putMessageField(&message, 3, &label);
+
+      putMessageField(&profile, 2, &message);
+    }
+  }
+  pthread_mutex_unlock(&HP_siteLock);
+
+  /* One location per frame, with one line per source function; with
+   * inlining, innermost comes first. Without source information (i.e.
+   * unless the program was compiled with -profile), frames are named by
+   * their index. */
+  for (GC_frameIndex fi = 0; fi < s->frameInfosLength; fi++) {
+    if (!frameUsed[fi])
+      continue;
+
+    putUintField(&message, 1, (uint64_t)fi + 1);
+
+    bool haveLine = FALSE;
+    const uint32_t *sourceSeq = GC_frameIndexSourceSeq(s, fi);
+    for (uint32_t j = sourceSeq[0]; j >= 1; j--) {
+      GC_sourceIndex si = sourceSeq[j];
+      if (UNKNOWN_SOURCE_INDEX == si || si >= s->sourceMaps.sourcesLength)
+        continue;
+      putUintField(&line, 1, internFunction(&strings, getSourceName(s, si)));
+      putMessageField(&message, 4, &line);
+      haveLine = TRUE;
+    }
+
+    if (!haveLine) {
+      char name[32];
+      snprintf(name, sizeof(name), "frame %"PRIu32, (uint32_t)fi);
+      putUintField(&line, 1, internFunction(&strings, name));
+      putMessageField(&message, 4, &line);
+    }
+
+    putMessageField(&profile, 4, &message);
+  }
+
+  for (size_t i = 0; i < strings.length; i++) {
+    if (!strings.isFunction[i])
+      continue;
+    putUintField(&message, 1, i);
+    putUintField(&message, 2, i);
+    putUintField(&message, 3, i);
+    putMessageField(&profile, 5, &message);
+  }
+
+  putValueType(&profile, 11, &strings, "space", "bytes");
+  putUintField(&profile, 12, s->controls->heapProfileRate);
+  putUintField(&profile, 14, internString(&strings, "alloc_space"));
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  putUintField(&profile, 9,
+               (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec);
+
+  /* must come last, since everything above may add strings */
+  for (size_t i = 0; i < strings.length; i++)
+    putBytesField(&profile, 6, strings.strings[i], strlen(strings.strings[i]));
+
+  FILE *f = s->controls->heapProfileFile;
+  if (fwrite(profile.data, 1, profile.length, f) < profile.length)
+    DIE("Could not write heap profile.");
+  fclose(f);
+  s->controls->heapProfileFile = NULL;
+
+  for (size_t i = 0; i < strings.length; i++)
+    free(strings.strings[i]);
+  free(strings.strings);
+  free(strings.isFunction);
+  free(strings.index);
+  free(profile.data);
+  free(message.data);
+  free(packed.data);
+  free(label.data);
+  free(line.data);
+  free(frameUsed);
+}
+
+#endif /* MLTON_GC_INTERNAL_FUNCS */
@@ -0,0 +1,121 @@
+/** Sampling heap profiler.
+  *
+  * The mutator allocates inline, so the runtime only sees it when it needs a
+  * fresh chunk. Sampling is therefore driven by chunks: once roughly
+  * `heap-profile-rate` bytes of chunks have been handed to the mutator, the
+  * first object allocated in the next chunk is sampled. We record its
+  * allocation site (the frame indices of the call stack) and the depth of the
+  * heap it was allocated in, and then follow the object through the
+  * collector. A sample stands for all the chunk bytes handed out since the
+  * previous sample, i.e. for that many bytes' worth of objects of its own
+  * size. Each sample ends up in one of four places:
+  *   - still live at exit, possibly after surviving local GCs,
+  *   - promoted to a shallower heap (this is in addition to the above),
+  *   - reclaimed by a local GC, or
+  *   - reclaimed by a concurrent (CC) collection.
+  *
+  * Samples are attached to the chunk holding the sampled object, so that the
+  * collector only needs to look for them in chunks where chunk->heapSamples is
+  * non-NULL. At exit, the per-site totals are written as an uncompressed
+  * pprof profile.proto, which `pprof` and `go tool pprof` read directly.
+  */
+
+#ifndef HEAP_PROFILE_H_
+#define HEAP_PROFILE_H_
+
+#if (defined (MLTON_GC_INTERNAL_TYPES))
+
+#define HP_MAX_FRAMES 32
+
+/* An allocation site: a (truncated) call stack and an allocation depth.
+ * Sites are shared by all processors and never freed. All counters are
+ * updated atomically. */
+typedef struct HP_site {
+  struct HP_site *next; /* in the hash bucket */
+  uint32_t depth;
+  uint32_t numFrames;
+  GC_frameIndex frames[HP_MAX_FRAMES]; /* innermost first */
+
+  uint64_t allocObjects;
+  uint64_t allocBytes;
+  uint64_t survivedObjects;
+  uint64_t survivedBytes;
+  uint64_t promotedObjects;
+  uint64_t promotedBytes;
+  uint64_t localReclaimedObjects;
+  uint64_t localReclaimedBytes;
+  uint64_t ccReclaimedObjects;
+  uint64_t ccReclaimedBytes;
+} *HP_site;
+
+/* A sampled object, linked from the chunk which holds it. Until the object
+ * has actually been allocated we only know where it will begin; its size
+ * (and therefore its weight) is filled in by HP_resolveSample. */
+typedef struct HP_sample {
+  struct HP_sample *next;
+  HP_site site;
+  pointer start;    /* beginning of the object metadata */
+  uint64_t representedBytes; /* chunk bytes handed out since the last sample */
+  uint64_t weightObjects; /* 0 if not yet resolved */
+  uint64_t weightBytes;
+  bool survived;
+  bool promoted;
+} *HP_sample;
+
+/* Per-processor sampling state. */
+struct HP_sampler {
+  int64_t bytesUntilSample;
+  uint64_t bytesSinceSample;
+  uint64_t random;
+};
+
+#endif /* MLTON_GC_INTERNAL_TYPES */
+
+#if (defined (MLTON_GC_INTERNAL_FUNCS))
+
+static inline bool HP_isEnabled(GC_state s);
+
+/* Count a freshly acquired allocation chunk against the sampling budget of
+ * this processor, and sample the next object allocated at `start` if the
+ * budget ran out. */
+void HP_sampleAllocation(GC_state s, HM_chunk chunk, pointer start, size_t bytes);
+
+/* Fill in the size of every sample in `chunk` whose object has now been
+ * allocated, i.e. begins before `frontier`. */
+void HP_resolveSamples(GC_state s, HM_chunk chunk, pointer frontier);
+
+/* Move a not-yet-allocated sample, e.g. when a large sequence is split off
+ * into a chunk of its own. */
+void HP_moveSample(HM_chunk from, pointer start, HM_chunk to, pointer newStart);
+
+/* Follow a sampled object (if there is one at `start`) which is being copied
+ * or moved by the collector from depth `fromDepth` to depth `toDepth`. */
+void HP_relocateSample(GC_state s,
+                       HM_chunk from,
+                       pointer start,
+                       HM_chunk to,
+                       pointer newStart,
+                       size_t bytes,
+                       uint32_t fromDepth,
+                       uint32_t toDepth);
+
+/* All samples remaining in `list` are about to be freed along with it. */
+void HP_reclaimSamples(GC_state s, HM_chunkList list, bool byCC);
+
+/* The objects of `chunk` at or after `start` are dead, and the frontier of
+ * the chunk is about to be moved back to `start` by a concurrent collection. */
+void HP_reclaimSamplesPast(GC_state s, HM_chunk chunk, pointer start);
+
+/* The object at `start` is dead, but stays in its chunk, which a compacting
+ * local collection keeps in place. */
+void HP_reclaimSampleAt(GC_state s, HM_chunk chunk, pointer start);
+
+/* Forget about any samples of a chunk that is being reused. */
+void HP_discardSamples(HM_chunk chunk);
+
+/* Write the profile, if enabled. Called once at exit. */
+void HP_writeProfile(GC_state s);
+
+#endif /* MLTON_GC_INTERNAL_FUNCS */
+
+#endif /* HEAP_PROFILE_H_ */
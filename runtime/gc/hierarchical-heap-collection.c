@@ -59,6 +59,56 @@ bool skipStackAndThreadObjptrPredicate(GC_state s,
                                        pointer p,
                                        void* rawArgs);
 
+/**
+ * Marking for `@mpl local-gc compact`. Before copying, a compacting local
+ * collection marks (in the object headers) everything that the copy will
+ * reach, and counts the live bytes of each chunk. Chunks which are at least
+ * half live are then kept in place: relocateObject moves the whole chunk into
+ * the to-space when it first reaches one of its objects, instead of copying
+ * them, and the dead objects left behind are cleared of pointers. Only the
+ * remaining, sparse chunks need to-space.
+ */
+struct MarkLocalArgs {
+  uint32_t minDepth;
+  uint32_t maxDepth;
+  pointer currentStack;
+  CC_stack worklist;
+  size_t bytesMarked;
+};
+
+void markLocalObjptr(GC_state s, objptr* opp, void* rawArgs);
+void markLocalDownPtr(GC_state s, objptr dst, objptr* field, objptr src, void* rawArgs);
+void markLocalHeap(GC_state s,
+                   GC_thread thread,
+                   HM_chunkList globalDownPtrs,
+                   uint32_t minDepth,
+                   uint32_t maxDepth,
+                   size_t stackWatermark);
+bool shouldKeepChunkInPlace(GC_state s, HM_chunk chunk);
+void keepChunkInPlace(GC_state s,
+                      HM_chunk chunk,
+                      HM_HierarchicalHeap tgtHeap,
+                      struct ForwardHHObjptrArgs *args);
+
+/**
+ * Minor collections, for `@mpl minor-gcs N`. The chunks left in the leaf
+ * heap by a local collection are marked tenured (all but the last, which the
+ * mutator goes on allocating into). While the thread stays at that leaf, up
+ * to N collections in a row may then collect only the leaf and move its
+ * tenured chunks into the to-space as they are, so that only what was
+ * allocated since the last collection is copied. The tenured chunks are
+ * still scanned with the rest of the to-space: not every update of an old
+ * object goes through the write barrier, so there is no remembered set of
+ * old-to-young pointers to scan instead.
+ */
+bool canCollectMinor(GC_state s, GC_thread thread, uint32_t maxDepth);
+bool isTenuredChunkWalkable(GC_state s, HM_chunk chunk);
+void keepTenuredChunks(GC_state s,
+                       HM_HierarchicalHeap leaf,
+                       HM_HierarchicalHeap *toSpace,
+                       struct ForwardHHObjptrArgs *args);
+void tenureLeafChunks(HM_HierarchicalHeap leaf);
+
 /************************/
 /* Function Definitions */
 /************************/
@@ -122,6 +172,7 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
 
   Trace0(EVENT_GC_ENTER);
   TraceResetCopy();
+  setProfilePhase(s, PROFILE_PHASE_LOCAL_GC);
 
   s->cumulativeStatistics->numHHLocalGCs++;
 
@@ -135,6 +186,16 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
     minDepth = maxDepth;
   }
 
+  uint64_t ccEpoch = CC_numStarted();
+  bool minor = canCollectMinor(s, thread, maxDepth);
+  if (minor) {
+    minDepth = maxDepth;
+    s->cumulativeStatistics->numMinorGCs++;
+    s->minorGCsSinceMajor++;
+  } else {
+    s->minorGCsSinceMajor = 0;
+  }
+
   /* copy roots */
   struct ForwardHHObjptrArgs forwardHHObjptrArgs = {
     .hh = hh,
@@ -166,6 +227,7 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
   }
 
   Trace0(EVENT_PROMOTION_ENTER);
+  setProfilePhase(s, PROFILE_PHASE_PROMOTION);
   timespec_now(&startTime);
 
   struct HM_chunkList globalDownPtrs;
@@ -179,6 +241,8 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
   timespec_now(&stopTime);
   timespec_sub(&stopTime, &startTime);
   timespec_add(&(s->cumulativeStatistics->timeLocalPromo), &stopTime);
+  S_recordPause(s, GC_PAUSE_PROMO, &stopTime);
+  setProfilePhase(s, PROFILE_PHASE_LOCAL_GC);
   Trace0(EVENT_PROMOTION_LEAVE);
 
   if (needGCTime(s)) {
@@ -199,23 +263,42 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
       forwardHHObjptrArgs.minDepth,
       forwardHHObjptrArgs.maxDepth);
 
+  GC_stack stack = getStackCurrent(s);
+  size_t stackWatermark = getStackWatermark(s, forwardHHObjptrArgs.minDepth);
+  if (stackWatermark > stack->used) {
+    stackWatermark = 0;
+  }
+
+  if (!minor && LOCAL_GC_COMPACT == s->controls->localGCMode) {
+    markLocalHeap(s,
+                  thread,
+                  &globalDownPtrs,
+                  forwardHHObjptrArgs.minDepth,
+                  forwardHHObjptrArgs.maxDepth,
+                  stackWatermark);
+  }
+
   LOG(LM_HH_COLLECTION, LL_DEBUG, "START root copy");
 
   HM_HierarchicalHeap toSpace[maxDepth+1];
   for (uint32_t i = 0; i <= maxDepth; i++) toSpace[i] = NULL;
   forwardHHObjptrArgs.toSpace = &(toSpace[0]);
   forwardHHObjptrArgs.toDepth = HM_HH_INVALID_DEPTH;
-  /* forward contents of stack */
+  if (minor) {
+    keepTenuredChunks(s, hh, &(toSpace[0]), &forwardHHObjptrArgs);
+  }
+  /* forward contents of stack. Frames below the watermark of minDepth were
+   * pushed before the thread forked into minDepth, and can only point to
+   * shallower objects, which we would skip anyway (see thread.h). */
   oldObjectCopied = forwardHHObjptrArgs.objectsCopied;
-  foreachObjptrInObject(s,
-                        objptrToPointer(getStackCurrentObjptr(s),
-                                        NULL),
-                        &trueObjptrPredicateClosure,
-                        &forwardHHObjptrClosure,
-                        FALSE);
+  foreachObjptrInStackFrom(s, (pointer)stack, stackWatermark,
+                           &forwardHHObjptrClosure);
+  s->cumulativeStatistics->bytesStackScanSkipped += stackWatermark;
   LOG(LM_HH_COLLECTION, LL_DEBUG,
-      "Copied %"PRIu64" objects from stack",
-      forwardHHObjptrArgs.objectsCopied - oldObjectCopied);
+      "Copied %"PRIu64" objects from stack (skipped %zu of %zu bytes)",
+      forwardHHObjptrArgs.objectsCopied - oldObjectCopied,
+      stackWatermark,
+      stack->used);
   Trace3(EVENT_COPY,
    forwardHHObjptrArgs.bytesCopied,
    forwardHHObjptrArgs.objectsCopied,
@@ -348,6 +431,11 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
       HM_appendChunkList(getFreeListSmall(s), remset);
     }
 
+    /* whatever the heap profiler sampled here and did not see relocated is
+     * garbage */
+    if (HP_isEnabled(s))
+      HP_reclaimSamples(s, level, FALSE);
+
 #if ASSERT
     /* clear out memory to quickly catch some memory safety errors */
     HM_chunk chunkCursor = level->firstChunk;
@@ -359,6 +447,16 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
     }
 #endif
 
+    /* normally, chunks kept in place were moved to the to-space already */
+    if (LOCAL_GC_COMPACT == s->controls->localGCMode) {
+      for (HM_chunk chunk = HM_getChunkListFirstChunk(level);
+           NULL != chunk;
+           chunk = chunk->nextChunk)
+      {
+        chunk->keepInPlace = FALSE;
+      }
+    }
+
     HM_appendChunkList(getFreeListSmall(s), level);
     HM_HH_freeAllDependants(s, hhTail, FALSE);
     freeFixedSize(getUFAllocator(s), HM_HH_getUFNode(hhTail));
@@ -395,6 +493,12 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
   }
   thread->currentChunk = lastChunk;
 
+  if (0 < s->controls->hhConfig.minorGCs) {
+    tenureLeafChunks(toSpace[maxDepth]);
+    s->nurseryLeaf = toSpace[maxDepth];
+    s->nurseryCCEpoch = ccEpoch;
+  }
+
   if (lastChunk != NULL && !lastChunk->mightContainMultipleObjects) {
     if (!HM_HH_extend(s, thread, GC_HEAP_LIMIT_SLOP)) {
       DIE("Ran out of space for hierarchical heap!\n");
@@ -413,6 +517,9 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
   assertInvariants(thread);
 
   s->cumulativeStatistics->bytesHHLocaled += forwardHHObjptrArgs.bytesCopied;
+  if (minor) {
+    s->cumulativeStatistics->bytesCopiedMinor += forwardHHObjptrArgs.bytesCopied;
+  }
 
   /* SAM_NOTE: bytesSurvivedLastCollection is more precise than the
    * corresponding bytesAllocatedSinceLastCollection, which granularizes on
@@ -478,10 +585,14 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
   timespec_now(&stopTime);
   timespec_sub(&stopTime, &startTime);
   timespec_add(&(s->cumulativeStatistics->timeLocalGC), &stopTime);
+  S_recordPause(s, GC_PAUSE_LOCAL_GC, &stopTime);
 
   if (needGCTime(s)) {
     if (detailedGCTime(s)) {
       stopTiming(RUSAGE_THREAD, &ru_start, &s->cumulativeStatistics->ru_gcHHLocal);
+      if (minor) {
+        stopTiming(RUSAGE_THREAD, &ru_start, &s->cumulativeStatistics->ru_gcMinor);
+      }
     }
     /*
      * RAM_NOTE: small extra here since I recompute delta, but probably not a
@@ -490,6 +601,7 @@ void HM_HHC_collectLocal(uint32_t desiredScope) {
     stopTiming(RUSAGE_THREAD, &ru_start, &s->cumulativeStatistics->ru_gc);
   }
 
+  setProfilePhase(s, PROFILE_PHASE_MUTATOR);
   TraceResetCopy();
   Trace0(EVENT_GC_LEAVE);
 
@@ -528,6 +640,17 @@ objptr relocateObject(
   assert(!hasFwdPtr(p));
   assert(HM_HH_isLevelHead(tgtHeap));
 
+  if (HM_getChunkOf(p)->keepInPlace) {
+    keepChunkInPlace(s, HM_getChunkOf(p), tgtHeap, args);
+    return op;
+  }
+
+  /* drop the mark of a compacting collection, if any */
+  GC_header header = getHeader(p);
+  if (header & MARK_MASK) {
+    *(getHeaderp(p)) = header & ~MARK_MASK;
+  }
+
   HM_chunkList tgtChunkList = HM_HH_getChunkList(tgtHeap);
 
   size_t metaDataBytes;
@@ -545,9 +668,14 @@ objptr relocateObject(
     /* This chunk contains *only* this object, so no need to copy. Instead,
      * just move the chunk. Don't forget to update the levelHead, too! */
     HM_chunk chunk = HM_getChunkOf(p);
+    if (NULL != chunk->heapSamples) {
+      HP_relocateSample(s, chunk, p - metaDataBytes, chunk, p - metaDataBytes,
+                        objectBytes, HM_getObjptrDepth(op),
+                        HM_HH_getDepth(tgtHeap));
+    }
     HM_unlinkChunk(HM_HH_getChunkList(HM_getLevelHead(chunk)), chunk);
     HM_appendChunk(tgtChunkList, chunk);
-    chunk->levelHead = HM_HH_getUFNode(tgtHeap);
+    HM_setLevelHead(chunk, HM_HH_getUFNode(tgtHeap));
 
     LOG(LM_HH_COLLECTION, LL_DEBUGMORE,
       "Moved single-object chunk %p of size %zu",
@@ -563,6 +691,13 @@ objptr relocateObject(
                                    copyBytes,
                                    tgtHeap);
 
+  if (NULL != HM_getChunkOf(p)->heapSamples) {
+    HP_relocateSample(s, HM_getChunkOf(p), p - metaDataBytes,
+                      HM_getChunkOf(copyPointer), copyPointer,
+                      objectBytes, HM_getObjptrDepth(op),
+                      HM_HH_getDepth(tgtHeap));
+  }
+
   /* Store the forwarding pointer in the old object metadata. */
   *(getFwdPtrp(p)) = pointerToObjptr (copyPointer + metaDataBytes,
                                       NULL);
@@ -716,6 +851,305 @@ void forwardHHObjptr (GC_state s,
       *opp);
 }
 
+/* ========================================================================= */
+
+void markLocalObjptr(GC_state s, objptr* opp, void* rawArgs) {
+  struct MarkLocalArgs* args = (struct MarkLocalArgs*)rawArgs;
+  objptr op = *opp;
+
+  if (!isObjptr(op) || isObjptrInRootHeap(s, op)) {
+    return;
+  }
+
+  /* same filter as forwardHHObjptr */
+  uint32_t opDepth = HM_getObjptrDepthPathCompress(op);
+  if (opDepth < args->minDepth || opDepth > args->maxDepth) {
+    return;
+  }
+
+  pointer p = objptrToPointer(op, NULL);
+  while (hasFwdPtr(p)) {
+    op = getFwdPtr(p);
+    if (HM_getObjptrDepthPathCompress(op) < args->minDepth) {
+      return;
+    }
+    p = objptrToPointer(op, NULL);
+  }
+
+  GC_header header = getHeader(p);
+  if (header & MARK_MASK) {
+    return;
+  }
+  *(getHeaderp(p)) = header | MARK_MASK;
+
+  size_t bytes = sizeofObject(s, p);
+  HM_getChunkOf(p)->localLiveBytes += bytes;
+  args->bytesMarked += bytes;
+  CC_stack_push(&(args->worklist), p);
+}
+
+void markLocalDownPtr(GC_state s,
+                      __attribute__((unused)) objptr dst,
+                      __attribute__((unused)) objptr* field,
+                      objptr src,
+                      void* rawArgs)
+{
+  markLocalObjptr(s, &src, rawArgs);
+}
+
+void markLocalHeap(GC_state s,
+                   GC_thread thread,
+                   HM_chunkList globalDownPtrs,
+                   uint32_t minDepth,
+                   uint32_t maxDepth,
+                   size_t stackWatermark)
+{
+  for (HM_HierarchicalHeap cursor = thread->hierarchicalHeap;
+       NULL != cursor && HM_HH_getDepth(cursor) >= minDepth;
+       cursor = cursor->nextAncestor)
+  {
+    for (HM_chunk chunk = HM_getChunkListFirstChunk(HM_HH_getChunkList(cursor));
+         NULL != chunk;
+         chunk = chunk->nextChunk)
+    {
+      chunk->localLiveBytes = 0;
+      chunk->keepInPlace = FALSE;
+    }
+  }
+
+  struct MarkLocalArgs args = {
+    .minDepth = minDepth,
+    .maxDepth = maxDepth,
+    .currentStack = objptrToPointer(getStackCurrentObjptr(s), NULL),
+    .bytesMarked = 0
+  };
+  CC_stack_init(&(args.worklist), 1024);
+  struct GC_foreachObjptrClosure markClosure =
+    {.fun = markLocalObjptr, .env = &args};
+  struct HM_foreachDownptrClosure markDownPtrClosure =
+    {.fun = markLocalDownPtr, .env = &args};
+
+  /* the same roots as the copy, in HM_HHC_collectLocal */
+  foreachObjptrInStackFrom(s, args.currentStack, stackWatermark, &markClosure);
+  foreachObjptrInObject(s,
+                        objptrToPointer(getThreadCurrentObjptr(s), NULL),
+                        &trueObjptrPredicateClosure,
+                        &markClosure,
+                        FALSE);
+  markLocalObjptr(s, &(s->currentThread), &args);
+  foreachObjptrInObject(s,
+                        objptrToPointer(s->wsQueue, NULL),
+                        &trueObjptrPredicateClosure,
+                        &markClosure,
+                        FALSE);
+  HM_foreachRemembered(s, globalDownPtrs, &markDownPtrClosure);
+
+  while (CC_stack_size(&(args.worklist)) > 0) {
+    pointer p = CC_stack_pop(&(args.worklist));
+    if (p == args.currentStack) {
+      /* its frames were scanned above */
+      continue;
+    }
+    foreachObjptrInObject(s, p, &trueObjptrPredicateClosure, &markClosure, FALSE);
+  }
+  CC_stack_free(&(args.worklist));
+
+  size_t bytesKept = 0;
+  for (HM_HierarchicalHeap cursor = thread->hierarchicalHeap;
+       NULL != cursor && HM_HH_getDepth(cursor) >= minDepth;
+       cursor = cursor->nextAncestor)
+  {
+    for (HM_chunk chunk = HM_getChunkListFirstChunk(HM_HH_getChunkList(cursor));
+         NULL != chunk;
+         chunk = chunk->nextChunk)
+    {
+      if (shouldKeepChunkInPlace(s, chunk)) {
+        chunk->keepInPlace = TRUE;
+        bytesKept += chunk->localLiveBytes;
+      }
+    }
+  }
+
+  LOG(LM_HH_COLLECTION, LL_INFO,
+      "marked %zu bytes, keeping %zu of them in place",
+      args.bytesMarked,
+      bytesKept);
+}
+
+bool shouldKeepChunkInPlace(GC_state s, HM_chunk chunk) {
+  if (!chunk->mightContainMultipleObjects ||
+      0 == chunk->localLiveBytes ||
+      2 * chunk->localLiveBytes < HM_getChunkUsedSize(chunk))
+  {
+    return FALSE;
+  }
+
+  /* We need to be able to walk the chunk afterwards, which we can't past an
+   * object forwarded by promotion. Dead stacks and threads would also confuse
+   * skipStackAndThreadObjptrPredicate, so copy those chunks as usual. */
+  pointer q = HM_getChunkStart(chunk);
+  while (q < HM_getChunkFrontier(chunk)) {
+    pointer p = advanceToObjectData(s, q);
+    if (hasFwdPtr(p)) {
+      return FALSE;
+    }
+    GC_header header = getHeader(p);
+    if (!(header & MARK_MASK) &&
+        (header == GC_STACK_HEADER || header == GC_THREAD_HEADER))
+    {
+      return FALSE;
+    }
+    q = p + sizeofObjectNoMetaData(s, p);
+  }
+
+  return TRUE;
+}
+
+static void clearDeadObjptr(__attribute__((unused)) GC_state s,
+                            objptr* opp,
+                            __attribute__((unused)) void* rawArgs)
+{
+  *opp = BOGUS_OBJPTR;
+}
+
+void keepChunkInPlace(GC_state s,
+                      HM_chunk chunk,
+                      HM_HierarchicalHeap tgtHeap,
+                      struct ForwardHHObjptrArgs *args)
+{
+  HM_unlinkChunk(HM_HH_getChunkList(HM_getLevelHead(chunk)), chunk);
+  HM_appendChunk(HM_HH_getChunkList(tgtHeap), chunk);
+  HM_setLevelHead(chunk, HM_HH_getUFNode(tgtHeap));
+  chunk->keepInPlace = FALSE;
+
+  /* Unmark the live objects. The dead ones may point to chunks we are about
+   * to free, and will be scanned along with the rest of the to-space, so
+   * clear their pointers. */
+  struct GC_foreachObjptrClosure clearClosure =
+    {.fun = clearDeadObjptr, .env = NULL};
+  uint32_t depth = HM_HH_getDepth(tgtHeap);
+  pointer q = HM_getChunkStart(chunk);
+  while (q < HM_getChunkFrontier(chunk)) {
+    pointer p = advanceToObjectData(s, q);
+    GC_header header = getHeader(p);
+    pointer end = p + sizeofObjectNoMetaData(s, p);
+    if (header & MARK_MASK) {
+      *(getHeaderp(p)) = header & ~MARK_MASK;
+      if (NULL != chunk->heapSamples) {
+        HP_relocateSample(s, chunk, q, chunk, q, (size_t)(end - q),
+                          depth, depth);
+      }
+      args->objectsMoved++;
+    } else {
+      if (NULL != chunk->heapSamples) {
+        HP_reclaimSampleAt(s, chunk, q);
+      }
+      foreachObjptrInObject(s, p, &trueObjptrPredicateClosure,
+                            &clearClosure, FALSE);
+    }
+    q = end;
+  }
+
+  LOG(LM_HH_COLLECTION, LL_DEBUGMORE,
+      "Kept chunk %p in place, %zu of %zu bytes live",
+      (void*)chunk,
+      chunk->localLiveBytes,
+      HM_getChunkUsedSize(chunk));
+  args->bytesMoved += chunk->localLiveBytes;
+  s->cumulativeStatistics->bytesKeptInPlaceByLocal += chunk->localLiveBytes;
+}
+
+/* ========================================================================= */
+
+bool canCollectMinor(GC_state s, GC_thread thread, uint32_t maxDepth) {
+  HM_HierarchicalHeap leaf = thread->hierarchicalHeap;
+  uint32_t minorGCs = s->controls->hhConfig.minorGCs;
+
+  /* The root heap is collected concurrently. Elsewhere, a CC may have freed
+   * chunks which dead objects of the tenured chunks point to. */
+  return s->minorGCsSinceMajor < minorGCs
+         && NULL != s->nurseryLeaf
+         && s->nurseryLeaf == leaf
+         && HM_HH_getDepth(leaf) == maxDepth
+         && maxDepth >= 2
+         && s->nurseryCCEpoch == CC_numStarted();
+}
+
+bool isTenuredChunkWalkable(GC_state s, HM_chunk chunk) {
+  /* As for shouldKeepChunkInPlace: promotion may have forwarded objects out
+   * of the chunk since it was tenured, and any stack or thread but the
+   * current ones would trip skipStackAndThreadObjptrPredicate. */
+  pointer stack = objptrToPointer(getStackCurrentObjptr(s), NULL);
+  pointer threadp = objptrToPointer(getThreadCurrentObjptr(s), NULL);
+  pointer q = HM_getChunkStart(chunk);
+  while (q < HM_getChunkFrontier(chunk)) {
+    pointer p = advanceToObjectData(s, q);
+    if (hasFwdPtr(p)) {
+      return FALSE;
+    }
+    GC_header header = getHeader(p);
+    if ((header == GC_STACK_HEADER && p != stack) ||
+        (header == GC_THREAD_HEADER && p != threadp))
+    {
+      return FALSE;
+    }
+    q = p + sizeofObjectNoMetaData(s, p);
+  }
+
+  return TRUE;
+}
+
+void keepTenuredChunks(GC_state s,
+                       HM_HierarchicalHeap leaf,
+                       HM_HierarchicalHeap *toSpace,
+                       struct ForwardHHObjptrArgs *args)
+{
+  uint32_t depth = HM_HH_getDepth(leaf);
+  HM_chunkList list = HM_HH_getChunkList(leaf);
+  size_t bytesKept = 0;
+
+  HM_chunk chunk = HM_getChunkListFirstChunk(list);
+  while (NULL != chunk) {
+    HM_chunk next = chunk->nextChunk;
+
+    if (chunk->tenured && isTenuredChunkWalkable(s, chunk)) {
+      if (NULL == toSpace[depth]) {
+        toSpace[depth] = HM_HH_new(s, depth);
+      }
+      HM_unlinkChunk(list, chunk);
+      HM_appendChunk(HM_HH_getChunkList(toSpace[depth]), chunk);
+      HM_setLevelHead(chunk, HM_HH_getUFNode(toSpace[depth]));
+      bytesKept += HM_getChunkUsedSize(chunk);
+    } else {
+      chunk->tenured = FALSE;
+    }
+
+    chunk = next;
+  }
+
+  LOG(LM_HH_COLLECTION, LL_INFO,
+      "minor collection of depth %u, keeping %zu tenured bytes",
+      depth,
+      bytesKept);
+  args->bytesMoved += bytesKept;
+}
+
+void tenureLeafChunks(HM_HierarchicalHeap leaf) {
+  if (NULL == leaf) {
+    return;
+  }
+
+  HM_chunk last = HM_getChunkListLastChunk(HM_HH_getChunkList(leaf));
+  for (HM_chunk chunk = HM_getChunkListFirstChunk(HM_HH_getChunkList(leaf));
+       NULL != chunk;
+       chunk = chunk->nextChunk)
+  {
+    chunk->tenured = (chunk != last);
+  }
+}
+
+/* ========================================================================= */
+
 pointer copyObject(pointer p,
                    size_t objectSize,
                    size_t copySize,
@@ -752,7 +1186,7 @@ pointer copyObject(pointer p,
     if (NULL == chunk) {
       DIE("Ran out of space for Hierarchical Heap!");
     }
-    chunk->levelHead = HM_HH_getUFNode(tgtHeap);
+    HM_setLevelHead(chunk, HM_HH_getUFNode(tgtHeap));
   }
 
   pointer frontier = HM_getChunkFrontier(chunk);
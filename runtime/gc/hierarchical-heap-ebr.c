@@ -75,12 +75,14 @@ void HH_EBR_init(GC_state s) {
   s->hhEBR = ebr;
 
   ebr->epoch = 0;
+  /* gc threads retire HH records too (see Proc_numberOfStates) */
+  uint32_t numStates = Proc_numberOfStates(s);
   ebr->announce =
-    malloc(s->numberOfProcs * ANNOUNCEMENT_PADDING * sizeof(size_t));
+    malloc(numStates * ANNOUNCEMENT_PADDING * sizeof(size_t));
   ebr->local =
-    malloc(s->numberOfProcs * sizeof(struct HH_EBR_local));
+    malloc(numStates * sizeof(struct HH_EBR_local));
 
-  for (uint32_t i = 0; i < s->numberOfProcs; i++) {
+  for (uint32_t i = 0; i < numStates; i++) {
     // Everyone starts by announcing epoch = 0 and is non-quiescent
     setAnnouncement(s, i, PACK(0,0));
     ebr->local[i].limboIdx = 0;
@@ -94,7 +96,7 @@ void HH_EBR_init(GC_state s) {
 void HH_EBR_leaveQuiescentState(GC_state s) {
   HH_EBR_shared ebr = s->hhEBR;
   uint32_t mypid = s->procNumber;
-  uint32_t numProcs = s->numberOfProcs;
+  uint32_t numProcs = Proc_numberOfStates(s);
 
   size_t globalEpoch = ebr->epoch;
   size_t myann = getAnnouncement(s, mypid);
@@ -114,7 +116,9 @@ void HH_EBR_leaveQuiescentState(GC_state s) {
   if ( UNPACK_EPOCH(otherann) == globalEpoch || UNPACK_QBIT(otherann) ) {
     uint32_t c = ++ebr->local[mypid].checkNext;
     if (c >= numProcs) {
-      __sync_val_compare_and_swap(&(ebr->epoch), globalEpoch, globalEpoch+1);
+      if (__sync_bool_compare_and_swap(&(ebr->epoch), globalEpoch, globalEpoch+1)) {
+        Trace1(EVENT_EBR_EPOCH_ADVANCE, globalEpoch+1);
+      }
     }
   }
 
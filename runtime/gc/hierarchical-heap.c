@@ -248,6 +248,8 @@ HM_HierarchicalHeap HM_HH_new(GC_state s, uint32_t depth)
   hh->ufNode = uf;
   hh->subHeapForRootCC = NULL;
   hh->depth = depth;
+  s->numHeapsCreated++;
+  hh->cacheTag = ((uint64_t)(s->procNumber + 1) << 48) | s->numHeapsCreated;
   hh->nextAncestor = NULL;
   // hh->dependant1 = NULL;
   // hh->dependant2 = NULL;
@@ -334,13 +336,20 @@ bool HM_HH_extend(GC_state s, GC_thread thread, size_t bytesRequested)
     hh = newhh;
   }
 
+  chunk = CC_recycleRootChunk(s, thread, bytesRequested);
+  if (NULL != chunk) {
+    thread->currentChunk = chunk;
+    HM_HH_addRecentBytesAllocated(thread, HM_getChunkSizePastFrontier(chunk));
+    return TRUE;
+  }
+
   chunk = HM_allocateChunk(HM_HH_getChunkList(hh), bytesRequested);
 
   if (NULL == chunk) {
     return FALSE;
   }
 
-  chunk->levelHead = HM_HH_getUFNode(hh);
+  HM_setLevelHead(chunk, HM_HH_getUFNode(hh));
 
   thread->currentChunk = chunk;
   HM_HH_addRecentBytesAllocated(thread, HM_getChunkSize(chunk));
@@ -404,7 +413,7 @@ void mergeHeapForRootCC(GC_state s, GC_thread thread) {
   thread->hierarchicalHeap = newHH;
   HM_chunk chunk =
     HM_allocateChunk(HM_HH_getChunkList(newHH), GC_HEAP_LIMIT_SLOP);
-  chunk->levelHead = HM_HH_getUFNode(newHH);
+  HM_setLevelHead(chunk, HM_HH_getUFNode(newHH));
   thread->currentChunk = chunk;
   newHH->subHeapForRootCC = subhh;
 }
@@ -479,7 +488,7 @@ pointer HM_HH_getRoot(pointer threadp) {
 // 2. CC_REG:   This means that the root-set has been constructed but the collection hasn't started
 // 3. CC_COLLECTING: The collector sets this value to ccstate when it starts collecting using cas.
 //                   After its finished, the flag is set to CC_UNREG indicating that a new root set is needed.
-void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
+bool HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
   GC_state s = pthread_getspecific(gcstate_key);
   GC_thread thread = threadObjptrToStruct(s, pointerToObjptr(threadp, NULL));
 
@@ -520,7 +529,7 @@ void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
       assert(invariantForMutatorFrontier (s));
       assert(invariantForMutatorStack (s));
       endAtomic(s);
-      return;
+      return FALSE;
     }
   }
   else {
@@ -537,7 +546,7 @@ void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
       assert(invariantForMutatorFrontier (s));
       assert(invariantForMutatorStack (s));
       endAtomic(s);
-      return;
+      return FALSE;
     }
   }
   assert(HM_getLevelHead(HM_getChunkOf(kl)) == hh);
@@ -551,6 +560,11 @@ void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
 
   CC_clearStack(HM_HH_getConcurrentPack(hh));
   HM_HH_getConcurrentPack(hh)->ccstate = CC_REG;
+  bool handedOff = FALSE;
+  if (HM_HH_getDepth(hh) == 1 && s->controls->gcThreads > 0) {
+    CC_requestRootCollection(thread, hh);
+    handedOff = TRUE;
+  }
 
   s->frontier = HM_HH_getFrontier(thread);
   s->limitPlusSlop = HM_HH_getLimit(thread);
@@ -559,6 +573,7 @@ void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp) {
   assert(invariantForMutatorFrontier (s));
   assert(invariantForMutatorStack (s));
   endAtomic(s);
+  return handedOff;
 }
 
 HM_HierarchicalHeap HM_HH_getCurrent(GC_state s) {
@@ -673,15 +688,24 @@ void HM_HH_addRootForCollector(HM_HierarchicalHeap hh, pointer p) {
 }
 
 
-void HM_HH_freeAllDependants(
+static inline void freeDependant(
   GC_state s,
-  HM_HierarchicalHeap hh,
+  HM_UnionFindNode node,
   bool retireInsteadOfFree)
 {
-  assert(HM_HH_isLevelHead(hh));
-  FixedSizeAllocator myUFAllocator = getUFAllocator(s);
+  if (retireInsteadOfFree) {
+    HH_EBR_retire(s, node);
+  } else {
+    freeFixedSize(getUFAllocator(s), node);
+  }
+}
 
-  HM_UnionFindNode parent = HM_HH_getUFNode(hh);
+/* Free the dependants below parent->dependant1, in constant space. */
+static size_t freeDependantsInPlace(
+  GC_state s,
+  HM_UnionFindNode parent,
+  bool retireInsteadOfFree)
+{
   HM_UnionFindNode child = parent->dependant1;
   parent->dependant1 = NULL;
 
@@ -728,14 +752,8 @@ void HM_HH_freeAllDependants(
       if (child->dependant1 == NULL) {
         // free and jump to other grandchild
         HM_UnionFindNode grandchild = child->dependant2;
-
-        if (retireInsteadOfFree) {
-          HH_EBR_retire(s, child);
-        } else {
-          freeFixedSize(myUFAllocator, child);
-        }
+        freeDependant(s, child, retireInsteadOfFree);
         numFreed++;
-
         child = grandchild;
       }
       else {
@@ -748,6 +766,93 @@ void HM_HH_freeAllDependants(
     }
   }
 
+  return numFreed;
+}
+
+/* Free the dependants below parent->dependant1 breadth-first, queueing at
+ * most `capacity` of them. Each node is prefetched when it is queued, and
+ * only visited once the nodes queued before it have been, so with a bushy
+ * tree many of the cache misses overlap. The walk above has to wait for
+ * each node before it can find the next. Subtrees which don't fit in the
+ * queue are freed in place. */
+static size_t freeDependantsBreadthFirst(
+  GC_state s,
+  HM_UnionFindNode parent,
+  HM_UnionFindNode *queue,
+  size_t capacity,
+  bool retireInsteadOfFree)
+{
+  size_t head = 0;
+  size_t tail = 0;
+  size_t numFreed = 0;
+
+  if (NULL != parent->dependant1 && capacity > 0) {
+    queue[tail++] = parent->dependant1;
+  }
+  parent->dependant1 = NULL;
+
+  while (head < tail) {
+    HM_UnionFindNode node = queue[head++];
+    HM_UnionFindNode children[2] = {node->dependant1, node->dependant2};
+
+    for (int i = 0; i < 2; i++) {
+      HM_UnionFindNode child = children[i];
+      if (NULL == child) {
+        continue;
+      }
+      if (tail < capacity) {
+        __builtin_prefetch(child);
+        queue[tail++] = child;
+      } else {
+        struct HM_UnionFindNode top =
+          {.representative = NULL, .payload = NULL,
+           .dependant1 = child, .dependant2 = NULL};
+        numFreed += freeDependantsInPlace(s, &top, retireInsteadOfFree);
+      }
+    }
+
+    freeDependant(s, node, retireInsteadOfFree);
+    numFreed++;
+  }
+
+  return numFreed;
+}
+
+#define SMALL_DEPENDANTS_QUEUE 256
+
+void HM_HH_freeAllDependants(
+  GC_state s,
+  HM_HierarchicalHeap hh,
+  bool retireInsteadOfFree)
+{
+  assert(HM_HH_isLevelHead(hh));
+
+  HM_UnionFindNode parent = HM_HH_getUFNode(hh);
+  size_t numFreed;
+
+  if (hh->numDependants <= SMALL_DEPENDANTS_QUEUE) {
+    HM_UnionFindNode queue[SMALL_DEPENDANTS_QUEUE];
+    numFreed = freeDependantsBreadthFirst(s, parent, queue,
+                                          SMALL_DEPENDANTS_QUEUE,
+                                          retireInsteadOfFree);
+  } else {
+    HM_UnionFindNode *queue =
+      malloc(hh->numDependants * sizeof(HM_UnionFindNode));
+    if (NULL == queue) {
+      numFreed = freeDependantsInPlace(s, parent, retireInsteadOfFree);
+    } else {
+      numFreed = freeDependantsBreadthFirst(s, parent, queue,
+                                            hh->numDependants,
+                                            retireInsteadOfFree);
+      free(queue);
+    }
+  }
+
+  LOG(LM_HIERARCHICAL_HEAP, LL_DEBUG,
+      "%s %zu dependants of depth %u",
+      retireInsteadOfFree ? "retired" : "freed",
+      numFreed,
+      hh->depth);
   assert(numFreed == hh->numDependants);
   hh->numDependants = 0;
   hh->heightDependants = 0;
@@ -772,6 +877,7 @@ static inline void linkInto(
   assert(NULL == HM_HH_getUFNode(right)->dependant2);
 
   HM_HH_getUFNode(right)->representative = HM_HH_getUFNode(left);
+  __atomic_store_n(&(right->cacheTag), 0, __ATOMIC_RELEASE);
   HM_HH_getUFNode(right)->dependant2 = HM_HH_getUFNode(left)->dependant1;
   HM_HH_getUFNode(left)->dependant1 = HM_HH_getUFNode(right);
 
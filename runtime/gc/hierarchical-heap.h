@@ -37,8 +37,8 @@ typedef struct HM_UnionFindNode {
    * list) is parallelism. After a union:
    *   height(r1) <- 1 + max(height(r1), height(r2))
    * So, the final tree should be approximately balanced. We can then enumerate
-   * all dependants efficiently in parallel. (This is important for parallel
-   * GC, although we haven't implemented this yet.)
+   * all dependants efficiently in parallel: HM_HH_freeAllDependants walks it
+   * breadth-first, so that the cache misses of a whole level overlap.
    */
   struct HM_UnionFindNode *dependant1;
   struct HM_UnionFindNode *dependant2;
@@ -50,6 +50,12 @@ typedef struct HM_HierarchicalHeap {
   struct HM_UnionFindNode *ufNode;
   uint32_t depth;
 
+  /* Identifies this heap to the level head caches of chunks (see struct
+   * HM_chunk). Unique among all heaps ever created, so that a cache entry
+   * can't match a later heap that reuses this record; 0 once the heap has
+   * been linked into another. */
+  uint64_t cacheTag;
+
   struct HM_chunkList chunkList;
 
   /** This is a bit of a hack. For root (fully concurrent) collections,
@@ -144,12 +150,17 @@ uint32_t HM_HH_desiredCollectionScope(GC_state s, GC_thread thread);
 
 void HM_HH_forceLeftHeap(uint32_t processor, pointer threadp);
 pointer HM_HH_getRoot(pointer threadp);
-void HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp);
+/* Returns TRUE if the root heap was handed to a gc thread (see
+ * CC_requestRootCollection), in which case the scheduler has no collection
+ * task to run. */
+bool HM_HH_registerCont(pointer kl, pointer kr, pointer k, pointer threadp);
 void HM_HH_resetList(pointer threadp);
 
 
-/** Very fancy (constant-space) loop that frees each dependant union-find
-  * node of hh. Specifically, calls this on each dependant ufnode:
+/** Frees each dependant union-find node of hh, breadth-first through a queue
+  * sized by hh->numDependants, or with a very fancy constant-space loop if
+  * the queue can't be allocated. Specifically, calls this on each dependant
+  * ufnode:
   *
   *   freeFixedSize(getUFAllocator(s), ufnode)
   *
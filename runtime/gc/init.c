@@ -149,6 +149,46 @@ int processAtMLton (GC_state s, int start, int argc, char **argv,
                  atName,
                  format);
           }
+        } else if (0 == strcmp (arg, "stats-interval")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s stats-interval missing argument.", atName);
+          s->controls->statsInterval = stringToInt (argv[i++]);
+        } else if (0 == strcmp (arg, "stats-file")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s stats-file missing argument.", atName);
+          const char* filePath = argv[i++];
+          if (0 == strcmp(filePath, "-")) {
+            s->controls->statsFile = stdout;
+          } else {
+            s->controls->statsFile = fopen(filePath, "a");
+            if (s->controls->statsFile == NULL) {
+              die ("Invalid %s stats-file %s (%s).", atName, filePath, strerror(errno));
+            }
+          }
+        } else if (0 == strcmp (arg, "heap-profile")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s heap-profile missing argument.", atName);
+          const char* filePath = argv[i++];
+          s->controls->heapProfileFile = fopen(filePath, "wb");
+          if (s->controls->heapProfileFile == NULL) {
+            die ("Invalid %s heap-profile %s (%s).", atName, filePath, strerror(errno));
+          }
+        } else if (0 == strcmp (arg, "heap-profile-rate")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s heap-profile-rate missing argument.", atName);
+          s->controls->heapProfileRate = stringToBytes (argv[i++]);
+          if (0 == s->controls->heapProfileRate)
+            die ("%s heap-profile-rate must be positive.", atName);
+        } else if (0 == strcmp (arg, "perf-counters")) {
+          i++;
+          s->controls->perfCounters = TRUE;
+        } else if (0 == strcmp (arg, "profile-split-gc")) {
+          i++;
+          s->controls->profileSplitGC = TRUE;
         } else if (0 == strcmp (arg, "set-affinity")) {
           i++;
           s->controls->setAffinity = TRUE;
@@ -162,6 +202,19 @@ int processAtMLton (GC_state s, int start, int argc, char **argv,
           if (i == argc || (0 == strcmp (argv[i], "--")))
             die ("%s affinity-stride missing argument.", atName);
           s->controls->affinityStride = stringToInt (argv[i++]);
+        } else if (0 == strcmp (arg, "gc-threads")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s gc-threads missing argument.", atName);
+          int gcThreads = stringToInt (argv[i++]);
+          if (gcThreads < 0)
+            die ("%s gc-threads must be >= 0", atName);
+          s->controls->gcThreads = gcThreads;
+        } else if (0 == strcmp (arg, "gc-affinity-base")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--")))
+            die ("%s gc-affinity-base missing argument.", atName);
+          s->controls->gcAffinityBase = stringToInt (argv[i++]);
         } else if (0 == strcmp (arg, "load-world")) {
           unless (s->controls->mayLoadWorld)
             die ("May not load world.");
@@ -170,6 +223,16 @@ int processAtMLton (GC_state s, int start, int argc, char **argv,
           if (i == argc || 0 == strcmp (argv[i], "--"))
             die ("%s load-world missing argument.", atName);
           *worldFile = argv[i++];
+        } else if (0 == strcmp(arg, "log-binary")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--"))) {
+            die("%s log-binary missing argument.", atName);
+          }
+
+          const char* prefix = argv[i++];
+          if (!L_openBinaryLog(prefix)) {
+            diee("%s Could not open specified binary log.", atName);
+          }
         } else if (0 == strcmp(arg, "log-file")) {
           i++;
           if (i == argc || (0 == strcmp (argv[i], "--"))) {
@@ -301,6 +364,22 @@ int processAtMLton (GC_state s, int start, int argc, char **argv,
                  atName,
                  collectType);
           }
+        } else if (0 == strcmp (arg, "local-gc")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--"))) {
+            die ("%s local-gc missing argument.", atName);
+          }
+          const char* mode = argv[i++];
+          if (0 == strcmp (mode, "copy")) {
+            s->controls->localGCMode = LOCAL_GC_COPY;
+          } else if (0 == strcmp (mode, "compact")) {
+            s->controls->localGCMode = LOCAL_GC_COMPACT;
+          } else {
+            die ("%s local-gc \"%s\" invalid. Must be one of "
+                 "copy or compact.",
+                 atName,
+                 mode);
+          }
         } else if (0 == strcmp(arg, "collection-threshold-ratio")) {
           i++;
           if (i == argc || (0 == strcmp (argv[i], "--"))) {
@@ -329,6 +408,39 @@ int processAtMLton (GC_state s, int start, int argc, char **argv,
             die ("%s min-collection-depth must be > 0", atName);
           }
           s->controls->hhConfig.minLocalDepth = minDepth;
+        } else if (0 == strcmp(arg, "cc-recycle-threshold")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--"))) {
+            die ("%s cc-recycle-threshold missing argument.", atName);
+          }
+
+          double threshold = stringToFloat(argv[i++]);
+          if (threshold < 0.0 || threshold > 1.0) {
+            die ("%s cc-recycle-threshold must be between 0.0 and 1.0", atName);
+          }
+          s->controls->hhConfig.recycleThreshold = threshold;
+        } else if (0 == strcmp(arg, "internal-cc-level-budget")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--"))) {
+            die ("%s internal-cc-level-budget missing argument.", atName);
+          }
+
+          int budget = stringToInt(argv[i++]);
+          if (budget < 0) {
+            die ("%s internal-cc-level-budget must be >= 0", atName);
+          }
+          s->controls->hhConfig.internalCCLevelBudget = budget;
+        } else if (0 == strcmp(arg, "minor-gcs")) {
+          i++;
+          if (i == argc || (0 == strcmp (argv[i], "--"))) {
+            die ("%s minor-gcs missing argument.", atName);
+          }
+
+          int minors = stringToInt(argv[i++]);
+          if (minors < 0) {
+            die ("%s minor-gcs must be >= 0", atName);
+          }
+          s->controls->hhConfig.minorGCs = minors;
         } else if (0 == strcmp(arg, "trace-buffer-size")) {
           i++;
           if (i == argc || (0 == strcmp (argv[i], "--"))) {
@@ -372,6 +484,8 @@ int GC_init (GC_state s, int argc, char **argv) {
   s->controls->setAffinity = FALSE;
   s->controls->affinityBase = 0;
   s->controls->affinityStride = 1;
+  s->controls->gcThreads = 0;
+  s->controls->gcAffinityBase = -1;
   s->controls->ratios.ramSlop = 0.5f;
   s->controls->ratios.stackCurrentGrow = 2.0f;
   s->controls->ratios.stackCurrentMaxReserved = 32.0f;
@@ -382,11 +496,21 @@ int GC_init (GC_state s, int argc, char **argv) {
   s->controls->hhConfig.collectionThresholdRatio = 8.0;
   s->controls->hhConfig.minCollectionSize = 1024L * 1024L;
   s->controls->hhConfig.minLocalDepth = 2;
+  s->controls->hhConfig.recycleThreshold = 0.25;
+  s->controls->hhConfig.internalCCLevelBudget = 0;
+  s->controls->hhConfig.minorGCs = 0;
   s->controls->rusageMeasureGC = FALSE;
+  s->controls->profileSplitGC = FALSE;
+  s->controls->perfCounters = FALSE;
   s->controls->summary = FALSE;
   s->controls->summaryFormat = HUMAN;
   s->controls->summaryFile = stderr;
+  s->controls->statsInterval = 0;
+  s->controls->statsFile = stderr;
+  s->controls->heapProfileFile = NULL;
+  s->controls->heapProfileRate = 512 * 1024;
   s->controls->collectionType = ALL;
+  s->controls->localGCMode = LOCAL_GC_COPY;
   s->controls->traceBufferSize = 10000;
 
   /* Not arbitrary; should be at least the page size and must also respect the
@@ -438,6 +562,18 @@ int GC_init (GC_state s, int argc, char **argv) {
   s->weaks = NULL;
   s->saveWorldStatus = true;
   s->trace = NULL;
+  s->heapSampler.bytesUntilSample = 0;
+  s->heapSampler.bytesSinceSample = 0;
+  s->heapSampler.random = 0;
+  HPC_init(&(s->perfCounters));
+  s->census = NULL;
+  s->binaryLog = NULL;
+  s->nextInternalCCDepth = 2;
+  clearStackWatermarks(s, 0);
+  s->nurseryLeaf = NULL;
+  s->nurseryCCEpoch = 0;
+  s->numHeapsCreated = 0;
+  s->minorGCsSinceMajor = 0;
   srand48_r(0, &(s->tlsObjects.drand48_data));
 
   /* RAM_NOTE: Why is this not found in the Spoonhower copy? */
@@ -510,12 +646,15 @@ void GC_lateInit (GC_state s) {
 
   s->nextChunkAllocSize = s->controls->allocChunkSize;
 
+  initSchedulerStatistics(s->cumulativeStatistics, s->numberOfProcs);
+
   /* Initialize profiling.  This must occur after processing
    * command-line arguments, because those may just be doing a
    * show-sources, in which case we don't want to initialize the
    * atExit.
    */
   initProfiling (s);
+  HPC_initThread (s);
   if (s->amOriginal) {
     initWorld (s);
   } else {
@@ -534,6 +673,7 @@ void GC_duplicate (GC_state d, GC_state s) {
   d->controls = s->controls;
   d->globalCumulativeStatistics = s->globalCumulativeStatistics;
   d->cumulativeStatistics = newCumulativeStatistics();
+  initSchedulerStatistics(d->cumulativeStatistics, s->numberOfProcs);
   d->currentThread = BOGUS_OBJPTR;
   d->wsQueue = BOGUS_OBJPTR;
   d->wsQueueTop = BOGUS_OBJPTR;
@@ -565,6 +705,18 @@ void GC_duplicate (GC_state d, GC_state s) {
   d->weaks = s->weaks;
   d->saveWorldStatus = s->saveWorldStatus;
   d->trace = NULL;
+  d->heapSampler.bytesUntilSample = 0;
+  d->heapSampler.bytesSinceSample = 0;
+  d->heapSampler.random = 0;
+  HPC_init(&(d->perfCounters));
+  d->census = NULL;
+  d->binaryLog = NULL;
+  d->nextInternalCCDepth = 2;
+  clearStackWatermarks(d, 0);
+  d->nurseryLeaf = NULL;
+  d->nurseryCCEpoch = 0;
+  d->numHeapsCreated = 0;
+  d->minorGCsSinceMajor = 0;
   srand48_r(0, &(d->tlsObjects.drand48_data));
 
   // SPOONHOWER_NOTE: better duplicate?
@@ -572,8 +724,7 @@ void GC_duplicate (GC_state d, GC_state s) {
 
   d->sysvals.ram = s->sysvals.ram;
 
-  // SPOONHOWER_NOTE: better duplicate
-  //initProfiling (d);
+  duplicateProfiling (d, s);
 
   // Multi-processor support is incompatible with saved-worlds
   assert(d->amOriginal);
@@ -582,8 +733,7 @@ void GC_duplicate (GC_state d, GC_state s) {
 }
 
 // AG_NOTE: is this the proper place for this function?
-void GC_traceInit(ARG_USED_FOR_TRACING GC_state s) {
-#ifdef ENABLE_TRACING
+void GC_traceInit(GC_state s) {
   char filename[256];
   const char *dir;
 
@@ -594,11 +744,36 @@ void GC_traceInit(ARG_USED_FOR_TRACING GC_state s) {
   snprintf(filename, 256, "%s/%d.%d.trace", dir, getpid(), s->procNumber);
   s->trace = TracingNewContext(filename, s->controls->traceBufferSize,
                                s->procNumber);
-#endif
+  TracingSetEnabled(TRUE);
+}
+
+void GC_startGCThreads(GC_state s) {
+  for (uint32_t k = 0; k < s->controls->gcThreads; k++) {
+    GC_state d = &(s->procStates[s->numberOfProcs + k]);
+    if (0 != pthread_create(&(d->self), NULL, CC_gcThreadLoop, d))
+      DIE("could not start gc thread %u", k);
+    pthread_detach(d->self);
+  }
 }
 
-void GC_traceFinish(ARG_USED_FOR_TRACING GC_state s) {
-#ifdef ENABLE_TRACING
+void GC_statsSnapshotInit(GC_state s) {
+  if (0 == s->controls->statsInterval)
+    return;
+  S_startStatisticsSnapshots(s);
+}
+
+void GC_traceFinish(GC_state s) {
   TracingCloseAndFreeContext(&s->trace);
-#endif
+}
+
+void GC_setTracingEnabled(__attribute__ ((unused)) GC_state s, bool b) {
+  TracingSetEnabled(b);
+}
+
+void GC_traceSchedEvent(GC_state s, uint32_t kind, uint64_t arg1, uint64_t arg2) {
+  assert(kind == EVENT_STEAL
+         || kind == EVENT_TASK_START
+         || kind == EVENT_TASK_FINISH
+         || kind == EVENT_DEQUE_DEPTH);
+  Trace2((int)kind, arg1, arg2);
 }
@@ -18,4 +18,8 @@ PRIVATE int GC_init (GC_state s, int argc, char **argv);
 PRIVATE void GC_lateInit (GC_state s);
 PRIVATE void GC_traceInit (GC_state s);
 PRIVATE void GC_traceFinish (GC_state s);
+PRIVATE void GC_statsSnapshotInit (GC_state s);
+PRIVATE void GC_startGCThreads (GC_state s);
+PRIVATE void GC_setTracingEnabled (GC_state s, bool b);
+PRIVATE void GC_traceSchedEvent (GC_state s, uint32_t kind, uint64_t arg1, uint64_t arg2);
 PRIVATE void GC_duplicate (GC_state d, GC_state s);
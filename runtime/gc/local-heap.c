@@ -56,6 +56,10 @@ void HM_ensureHierarchicalHeapAssurances(
   /* update hh before modification */
   HM_HH_updateValues(thread, s->frontier);
 
+  /* size any objects sampled by the heap profiler since we last came by */
+  if (NULL != thread->currentChunk && NULL != thread->currentChunk->heapSamples)
+    HP_resolveSamples(s, thread->currentChunk, s->frontier);
+
   if (s->limitPlusSlop < s->frontier) {
     DIE("s->limitPlusSlop (%p) < s->frontier (%p)",
         ((void*)(s->limit)),
@@ -74,9 +78,7 @@ void HM_ensureHierarchicalHeapAssurances(
 
   if (desiredScope <= thread->currentDepth) {
     /* too much allocated, so let's collect */
-    for(uint32_t i = 2; i < desiredScope; i++) {
-        CC_collectAtPublicLevel(s, thread, i);
-    }
+    CC_collectPublicLevels(s, thread, desiredScope);
 
     HM_HHC_collectLocal(desiredScope);
 
@@ -129,6 +131,13 @@ void HM_ensureHierarchicalHeapAssurances(
     s->frontier = HM_HH_getFrontier(thread);
     s->limitPlusSlop = HM_HH_getLimit(thread);
     s->limit = s->limitPlusSlop - GC_HEAP_LIMIT_SLOP;
+
+    if (HP_isEnabled(s)) {
+      HP_sampleAllocation(s,
+                          thread->currentChunk,
+                          s->frontier,
+                          HM_getChunkSize(thread->currentChunk));
+    }
   }
 
 #if ASSERT
@@ -13,6 +13,7 @@
  */
 
 #include "hierarchical-heap.h"
+#include "binary-log.h"
 
 #include <string.h>
 
@@ -22,6 +23,50 @@
 enum LogLevel L_logLevels[NUM_LOG_MODULES] = {LL_ERROR};
 bool L_flushLog[NUM_LOG_MODULES] = {FALSE};
 
+/********************/
+/* Static Variables */
+/********************/
+static const char* const LogModuleNames[NUM_LOG_MODULES] = {
+  [LM_ALLOCATION] = "allocation",
+  [LM_CHUNK] = "chunk",
+  [LM_CHUNK_POOL] = "chunk-pool",
+  [LM_DFS_MARK] = "dfs-mark",
+  [LM_FOREACH] = "foreach",
+  [LM_GARBAGE_COLLECTION] = "garbage-collection",
+  [LM_GLOBAL_LOCAL_HEAP] = "global-local-heap",
+  [LM_GC_STATE] = "gc-state",
+  [LM_HIERARCHICAL_HEAP] = "hierarchical-heap",
+  [LM_HH_COLLECTION] = "hh-collection",
+  [LM_HH_PROMOTION] = "hh-promotion",
+  [LM_CC_COLLECTION] = "cc-collection",
+  [LM_PARALLEL] = "parallel",
+  [LM_THREAD] = "thread"
+};
+
+static const char* const LogLevelNames[] = {
+  [LL_FORCE] = "FORCE",
+  [LL_ASSERT] = "ASSERT",
+  [LL_ERROR] = "ERROR",
+  [LL_WARNING] = "WARN",
+  [LL_INFO] = "INFO",
+  [LL_DEBUG] = "DEBUG",
+  [LL_DEBUGMORE] = "DEBUGM"
+};
+
+/* Binary logging is on iff binaryLogPrefix is set. Call sites are numbered
+ * from 1 and described in the shared sites file as they are first used. */
+static char* binaryLogPrefix = NULL;
+static pthread_mutex_t binaryLogSitesLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* binaryLogSitesFile = NULL;
+static uint32_t binaryLogNumSites = 0;
+/* Every binary log, newest first, so that they can be found by
+ * flushBinaryLogsOnFatalSignal. */
+static struct L_binaryLog* binaryLogs = NULL;
+
+/* The largest message, and the longest string argument, in binary. */
+#define L_MAX_BINARY_RECORD_SIZE 1024
+#define L_MAX_BINARY_STRING_LENGTH 256
+
 /******************************/
 /* Static Function Prototypes */
 /******************************/
@@ -45,6 +90,46 @@ bool stringToLogLevel(enum LogLevel* level, const char* levelString);
  */
 bool stringToLogModule(enum LogModule* module, const char* moduleString);
 
+/**
+ * Returns the number of call site 'site', describing it in the sites file
+ * the first time.
+ */
+uint32_t binaryLogSiteId(uint32_t* site,
+                         enum LogModule module,
+                         enum LogLevel level,
+                         const char* function,
+                         const char* format);
+
+/**
+ * Returns the binary log of processor 's', creating it (and its file) the
+ * first time.
+ */
+struct L_binaryLog* getBinaryLog(GC_state s);
+
+/**
+ * Writes out a buffer. Must hold the lock of 'log'.
+ */
+void flushBinaryLogLocked(struct L_binaryLog* log);
+
+/**
+ * Handler for the signals which end the program abnormally, including the
+ * SIGABRT raised by DIE(). Writes out every buffer whose lock is free (a
+ * buffer which was being written to at the time is lost), and then raises
+ * the signal again with its default action.
+ */
+void flushBinaryLogsOnFatalSignal(int signum);
+
+/**
+ * Encodes the arguments of a message in binary (see binary-log.h), as far as
+ * they fit in 'capacity' bytes.
+ *
+ * @return The number of bytes used.
+ */
+size_t encodeBinaryLogArgs(uint8_t* out,
+                           size_t capacity,
+                           const char* format,
+                           va_list substitutions);
+
 /************************/
 /* Function Definitions */
 /************************/
@@ -169,6 +254,106 @@ END:
   return retVal;
 }
 
+void L_logAt(uint32_t* site,
+             enum LogModule module,
+             enum LogLevel level,
+             const char* function,
+             const char* format,
+             ...) {
+  GC_state s = pthread_getspecific(gcstate_key);
+  va_list substitutions;
+  va_start(substitutions, format);
+
+  if ((NULL == binaryLogPrefix) || (NULL == s)) {
+    L_vlog(L_flushLog[module],
+           level,
+           (NULL == s) ? (-1) : (Proc_processorNumber(s)),
+           function,
+           format,
+           substitutions);
+    va_end(substitutions);
+    return;
+  }
+
+  uint8_t record[L_MAX_BINARY_RECORD_SIZE];
+  struct BinaryLogRecord header;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  header.nanoseconds =
+    (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+  header.site = binaryLogSiteId(site, module, level, function, format);
+  header.length = encodeBinaryLogArgs(record + sizeof(header),
+                                      sizeof(record) - sizeof(header),
+                                      format,
+                                      substitutions);
+  va_end(substitutions);
+  memcpy(record, &header, sizeof(header));
+  size_t size = sizeof(header) + header.length;
+
+  struct L_binaryLog* log = getBinaryLog(s);
+  pthread_mutex_lock(&log->lock);
+  if (log->used + size > L_BINARY_LOG_BUFFER_SIZE) {
+    flushBinaryLogLocked(log);
+  }
+  memcpy(log->buffer + log->used, record, size);
+  log->used += size;
+  if (L_flushLog[module]) {
+    flushBinaryLogLocked(log);
+  }
+  pthread_mutex_unlock(&log->lock);
+}
+
+bool L_openBinaryLog(const char* prefix) {
+  char path[PATH_MAX];
+  struct BinaryLogFileHeader header =
+    {.magic = BINARY_LOG_MAGIC, .processor = UINT32_MAX, .reserved = 0};
+
+  snprintf(path, sizeof(path), "%s.sites", prefix);
+  binaryLogSitesFile = fopen(path, "wb");
+  if (NULL == binaryLogSitesFile) {
+    return FALSE;
+  }
+  if (1 != fwrite(&header, sizeof(header), 1, binaryLogSitesFile)) {
+    return FALSE;
+  }
+  fflush(binaryLogSitesFile);
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = flushBinaryLogsOnFatalSignal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESETHAND;
+  int fatalSignals[] = {SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV};
+  for (size_t i = 0; i < sizeof(fatalSignals) / sizeof(fatalSignals[0]); i++) {
+    sigaction(fatalSignals[i], &sa, NULL);
+  }
+
+  binaryLogPrefix = strdup(prefix);
+  return TRUE;
+}
+
+void L_flushBinaryLog(GC_state s) {
+  struct L_binaryLog* log = __atomic_load_n(&(s->binaryLog), __ATOMIC_ACQUIRE);
+  if (NULL == log) {
+    return;
+  }
+
+  pthread_mutex_lock(&log->lock);
+  flushBinaryLogLocked(log);
+  pthread_mutex_unlock(&log->lock);
+}
+
+void L_flushAllBinaryLogs(GC_state s) {
+  if (NULL == s->procStates) {
+    L_flushBinaryLog(s);
+    return;
+  }
+
+  for (uint32_t proc = 0; proc < Proc_numberOfStates(s); proc++) {
+    L_flushBinaryLog(&(s->procStates[proc]));
+  }
+}
+
 /******************************/
 /* Static Function Defintions */
 /******************************/
@@ -198,34 +383,197 @@ bool stringToLogLevel(enum LogLevel* level, const char* levelString) {
 }
 
 bool stringToLogModule(enum LogModule* module, const char* moduleString) {
-  struct Conversion {
-    const char* string;
-    enum LogModule module;
-  };
-
-  struct Conversion conversions[] =
-      {{.string = "allocation", .module = LM_ALLOCATION},
-       {.string = "chunk", .module = LM_CHUNK},
-       {.string = "chunk-pool", .module = LM_CHUNK_POOL},
-       {.string = "dfs-mark", .module = LM_DFS_MARK},
-       {.string = "foreach", .module = LM_FOREACH},
-       {.string = "garbage-collection", .module = LM_GARBAGE_COLLECTION},
-       {.string = "global-local-heap", .module = LM_GLOBAL_LOCAL_HEAP},
-       {.string = "gc-state", .module = LM_GC_STATE},
-       {.string = "hierarchical-heap", .module = LM_HIERARCHICAL_HEAP},
-       {.string = "hh-collection", .module = LM_HH_COLLECTION},
-       {.string = "hh-promotion", .module = LM_HH_PROMOTION},
-       {.string = "cc-collection", .module = LM_CC_COLLECTION},
-       {.string = "parallel", .module = LM_PARALLEL},
-       {.string = "thread", .module = LM_THREAD}};
-  size_t numConversions = sizeof(conversions) / sizeof(*conversions);
-
-  for (size_t i = 0; i < numConversions; i++) {
-    if (0 == strcasecmp(conversions[i].string, moduleString)) {
-      *module = conversions[i].module;
+  for (size_t i = 0; i < NUM_LOG_MODULES; i++) {
+    if (0 == strcasecmp(LogModuleNames[i], moduleString)) {
+      *module = (enum LogModule)i;
       return TRUE;
     }
   }
 
   return FALSE;
 }
+
+uint32_t binaryLogSiteId(uint32_t* site,
+                         enum LogModule module,
+                         enum LogLevel level,
+                         const char* function,
+                         const char* format) {
+  uint32_t id = __atomic_load_n(site, __ATOMIC_ACQUIRE);
+  if (0 != id) {
+    return id;
+  }
+
+  pthread_mutex_lock(&binaryLogSitesLock);
+  id = *site;
+  if (0 == id) {
+    id = ++binaryLogNumSites;
+
+    const char* moduleName = LogModuleNames[module];
+    const char* levelName = LogLevelNames[level];
+    struct BinaryLogSite header = {
+      .id = id,
+      .moduleLength = strlen(moduleName),
+      .levelLength = strlen(levelName),
+      .functionLength = strlen(function),
+      .formatLength = strlen(format),
+      .reserved = 0
+    };
+    fwrite(&header, sizeof(header), 1, binaryLogSitesFile);
+    fwrite(moduleName, 1, header.moduleLength, binaryLogSitesFile);
+    fwrite(levelName, 1, header.levelLength, binaryLogSitesFile);
+    fwrite(function, 1, header.functionLength, binaryLogSitesFile);
+    fwrite(format, 1, header.formatLength, binaryLogSitesFile);
+    /* messages may reach the disk before the site otherwise */
+    fflush(binaryLogSitesFile);
+
+    __atomic_store_n(site, id, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&binaryLogSitesLock);
+
+  return id;
+}
+
+struct L_binaryLog* getBinaryLog(GC_state s) {
+  struct L_binaryLog* log = s->binaryLog;
+  if (NULL != log) {
+    return log;
+  }
+
+  char path[PATH_MAX];
+  uint32_t processor = Proc_processorNumber(s);
+  snprintf(path, sizeof(path), "%s.%u", binaryLogPrefix, processor);
+
+  log = malloc(sizeof(struct L_binaryLog));
+  if (NULL == log) {
+    DIE("could not allocate the binary log of processor %u", processor);
+  }
+  log->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (log->fd < 0) {
+    DIE("could not open binary log %s: %s", path, strerror(errno));
+  }
+  pthread_mutex_init(&log->lock, NULL);
+
+  struct BinaryLogFileHeader header =
+    {.magic = BINARY_LOG_MAGIC, .processor = processor, .reserved = 0};
+  memcpy(log->buffer, &header, sizeof(header));
+  log->used = sizeof(header);
+
+  pthread_mutex_lock(&binaryLogSitesLock);
+  log->next = binaryLogs;
+  __atomic_store_n(&binaryLogs, log, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&binaryLogSitesLock);
+
+  __atomic_store_n(&(s->binaryLog), log, __ATOMIC_RELEASE);
+  return log;
+}
+
+void flushBinaryLogLocked(struct L_binaryLog* log) {
+  size_t written = 0;
+  while (written < log->used) {
+    ssize_t n = write(log->fd, log->buffer + written, log->used - written);
+    if (n < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      /* give up on this buffer rather than losing the program */
+      break;
+    }
+    written += (size_t)n;
+  }
+  log->used = 0;
+}
+
+void flushBinaryLogsOnFatalSignal(int signum) {
+  for (struct L_binaryLog* log = __atomic_load_n(&binaryLogs, __ATOMIC_ACQUIRE);
+       NULL != log;
+       log = log->next)
+  {
+    if (0 == pthread_mutex_trylock(&log->lock)) {
+      flushBinaryLogLocked(log);
+      pthread_mutex_unlock(&log->lock);
+    }
+  }
+  raise(signum);
+}
+
+size_t encodeBinaryLogArgs(uint8_t* out,
+                           size_t capacity,
+                           const char* format,
+                           va_list substitutions) {
+  size_t used = 0;
+  struct BinaryLogSpec spec;
+
+#define PUT_WORD(w)                                     \
+  do {                                                  \
+    uint64_t putWord = (uint64_t)(w);                   \
+    if (used + sizeof(putWord) > capacity) {            \
+      return used;                                      \
+    }                                                   \
+    memcpy(out + used, &putWord, sizeof(putWord));      \
+    used += sizeof(putWord);                            \
+  } while (FALSE)
+
+  for (const char* p = BinaryLog_nextSpec(format, &spec);
+       NULL != p;
+       p = BinaryLog_nextSpec(p, &spec)) {
+    for (uint32_t i = 0; i < spec.numStars; i++) {
+      PUT_WORD((int64_t)va_arg(substitutions, int));
+    }
+
+    switch (spec.kind) {
+      case BLA_NONE:
+        break;
+      case BLA_INT:
+        PUT_WORD((int64_t)va_arg(substitutions, int));
+        break;
+      case BLA_LONG:
+        PUT_WORD((int64_t)va_arg(substitutions, long));
+        break;
+      case BLA_LLONG:
+        PUT_WORD((int64_t)va_arg(substitutions, long long));
+        break;
+      case BLA_SIZE:
+        PUT_WORD(va_arg(substitutions, size_t));
+        break;
+      case BLA_INTMAX:
+        PUT_WORD((int64_t)va_arg(substitutions, intmax_t));
+        break;
+      case BLA_PTRDIFF:
+        PUT_WORD((int64_t)va_arg(substitutions, ptrdiff_t));
+        break;
+      case BLA_DOUBLE:
+      case BLA_LDOUBLE: {
+        double d = (BLA_DOUBLE == spec.kind)
+                   ? va_arg(substitutions, double)
+                   : (double)va_arg(substitutions, long double);
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        PUT_WORD(bits);
+        break;
+      }
+      case BLA_POINTER:
+        PUT_WORD((uintptr_t)va_arg(substitutions, void*));
+        break;
+      case BLA_STRING: {
+        const char* string = va_arg(substitutions, const char*);
+        if (NULL == string) {
+          string = "(null)";
+        }
+        uint32_t length = strnlen(string, L_MAX_BINARY_STRING_LENGTH);
+        size_t padded = align(sizeof(length) + length, sizeof(uint64_t));
+        if (used + padded > capacity) {
+          return used;
+        }
+        memset(out + used, 0, padded);
+        memcpy(out + used, &length, sizeof(length));
+        memcpy(out + used + sizeof(length), string, length);
+        used += padded;
+        break;
+      }
+    }
+  }
+
+#undef PUT_WORD
+
+  return used;
+}
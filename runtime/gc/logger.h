@@ -49,6 +49,9 @@ extern bool L_flushLog[NUM_LOG_MODULES];
  * This is a convenience function for logging which automatically fetches the
  * processor number and function name.
  *
+ * A disabled message costs a single load and branch. Everything else, down
+ * to finding the processor, happens out of line in L_logAt().
+ *
  * @param module The module from enum LogModule that this log message belongs
  * to.
  * @param level The log level from enum LogLevel that this message belongs to.
@@ -56,13 +59,9 @@ extern bool L_flushLog[NUM_LOG_MODULES];
  */
 #define LOG(module, level, ...)                                         \
   do {                                                                  \
-    if (L_levelEnabled(level, L_logLevels[module])) {                   \
-      GC_state loggerS = pthread_getspecific(gcstate_key);              \
-      L_log(L_flushLog[module],                                         \
-            level,                                                      \
-            (NULL == loggerS) ? (-1) : (Proc_processorNumber(loggerS)), \
-            __func__,                                                   \
-            __VA_ARGS__);                                               \
+    if (__builtin_expect(LOG_ENABLED(module, level), FALSE)) {          \
+      static uint32_t loggerSite = 0;                                   \
+      L_logAt(&loggerSite, module, level, __func__, __VA_ARGS__);       \
     }                                                                   \
   } while(FALSE)
 
@@ -150,4 +149,61 @@ extern bool L_flushLog[NUM_LOG_MODULES];
  */
 bool initLogLevels(const char* arg);
 
+/**
+ * The size of the buffer of each processor when logging in binary. A
+ * processor writes out its buffer whenever it fills up.
+ */
+#define L_BINARY_LOG_BUFFER_SIZE (256 * 1024)
+
+/**
+ * The messages of one processor, when logging in binary (see binary-log.h).
+ * Only the processor itself appends to the buffer, so the lock is contended
+ * only when all buffers are flushed at exit.
+ */
+struct L_binaryLog {
+  pthread_mutex_t lock;
+  int fd;
+  size_t used;
+  struct L_binaryLog* next; /* the log created before this one */
+  uint8_t buffer[L_BINARY_LOG_BUFFER_SIZE];
+};
+
+/**
+ * Logs a message from the call site identified by 'site', either as text to
+ * the log file, or in binary if L_openBinaryLog() was called. Use LOG()
+ * rather than calling this directly.
+ *
+ * @param site A variable private to the call site, initially 0.
+ * @param module The module of the message.
+ * @param level The level of the message.
+ * @param function The function logging this message.
+ * @param format The format of the message as per 'printf()'
+ * @param ... The format arguments as per 'printf()'
+ */
+void L_logAt(uint32_t* site,
+             enum LogModule module,
+             enum LogLevel level,
+             const char* function,
+             const char* format,
+             ...)
+    __attribute__((format (printf, 5, 6)));
+
+/**
+ * Switches LOG() messages to binary logging, into files named after 'prefix'.
+ *
+ * @return TRUE if the site table 'prefix'.sites could be created, FALSE
+ * otherwise.
+ */
+bool L_openBinaryLog(const char* prefix);
+
+/**
+ * Writes out the binary log buffer of processor 's', if it has one.
+ */
+void L_flushBinaryLog(GC_state s);
+
+/**
+ * Writes out the binary log buffers of all processors.
+ */
+void L_flushAllBinaryLogs(GC_state s);
+
 #endif /* LOGGER_H_ */
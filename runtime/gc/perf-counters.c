@@ -0,0 +1,156 @@
+void HPC_init(struct HPC_counters *counters) {
+  counters->groupFd = -1;
+  counters->numOpen = 0;
+  for (uint32_t e = 0; e < GC_PERF_EVENTS; e++) {
+    counters->slot[e] = -1;
+    counters->last[e] = 0;
+  }
+}
+
+#if not HAS_PERF_COUNTERS
+
+void HPC_initThread(GC_state s) {
+  if (s->controls->perfCounters)
+    die ("perf-counters is only supported on Linux");
+}
+
+void HPC_chargePhase(__attribute__ ((unused)) GC_state s,
+                     __attribute__ ((unused)) GC_profilePhase phase) {
+}
+
+void HPC_done(__attribute__ ((unused)) GC_state s) {
+}
+
+#else
+
+static int openPerfEvent(uint32_t type, uint64_t config, int groupFd) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+    PERF_FORMAT_GROUP
+    | PERF_FORMAT_TOTAL_TIME_ENABLED
+    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  /* this thread, on any cpu */
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd,
+                      PERF_FLAG_FD_CLOEXEC);
+}
+
+#define HW_CACHE_READ_MISS(cache) \
+  ((cache) \
+   | (PERF_COUNT_HW_CACHE_OP_READ << 8) \
+   | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/* Current (cumulative) value of each event, scaled up if the group was only
+ * scheduled on the PMU for part of the time. */
+static bool readPerfCounters(struct HPC_counters *counters,
+                             uint64_t values[GC_PERF_EVENTS]) {
+  uint64_t buffer[3 + GC_PERF_EVENTS];
+
+  ssize_t n = read(counters->groupFd, buffer, sizeof(buffer));
+  if (n < (ssize_t)((3 + counters->numOpen) * sizeof(uint64_t)))
+    return FALSE;
+
+  uint64_t enabled = buffer[1];
+  uint64_t running = buffer[2];
+  double scale =
+    (0 < running and running < enabled)
+    ? (double)enabled / (double)running
+    : 1.0;
+
+  for (uint32_t e = 0; e < GC_PERF_EVENTS; e++) {
+    int32_t slot = counters->slot[e];
+    values[e] = (slot < 0) ? 0 : (uint64_t)((double)buffer[3 + slot] * scale);
+  }
+  return TRUE;
+}
+
+void HPC_initThread(GC_state s) {
+  static const struct {
+    uint32_t type;
+    uint64_t config;
+  } events[GC_PERF_EVENTS] = {
+    [GC_PERF_CYCLES] =
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [GC_PERF_INSTRUCTIONS] =
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [GC_PERF_LLC_MISSES] =
+      {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    [GC_PERF_DTLB_MISSES] =
+      {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+  };
+  struct HPC_counters *counters = &(s->perfCounters);
+
+  if (not s->controls->perfCounters)
+    return;
+
+  /* cycles lead the group; the others are optional */
+  counters->groupFd =
+    openPerfEvent(events[GC_PERF_CYCLES].type,
+                  events[GC_PERF_CYCLES].config,
+                  -1);
+  if (counters->groupFd < 0) {
+    if (0 == Proc_processorNumber(s))
+      fprintf(stderr,
+              "[GC: hardware performance counters unavailable: %s]\n",
+              strerror(errno));
+    HPC_init(counters);
+    return;
+  }
+  counters->slot[GC_PERF_CYCLES] = 0;
+  counters->numOpen = 1;
+
+  for (uint32_t e = 0; e < GC_PERF_EVENTS; e++) {
+    if (GC_PERF_CYCLES == e)
+      continue;
+    int fd = openPerfEvent(events[e].type, events[e].config, counters->groupFd);
+    if (fd >= 0) {
+      counters->slot[e] = (int32_t)counters->numOpen;
+      counters->numOpen++;
+    }
+  }
+
+  unless (readPerfCounters(counters, counters->last)) {
+    close(counters->groupFd);
+    HPC_init(counters);
+    return;
+  }
+  s->cumulativeStatistics->perf.enabled = TRUE;
+}
+
+void HPC_chargePhase(GC_state s, GC_profilePhase phase) {
+  struct HPC_counters *counters = &(s->perfCounters);
+  uint64_t now[GC_PERF_EVENTS];
+
+  if (counters->groupFd < 0)
+    return;
+  unless (readPerfCounters(counters, now))
+    return;
+
+  uint64_t *counts = s->cumulativeStatistics->perf.counts[phase];
+  for (uint32_t e = 0; e < GC_PERF_EVENTS; e++) {
+    /* scaling can make the estimate go backwards slightly */
+    if (now[e] > counters->last[e])
+      counts[e] += now[e] - counters->last[e];
+    counters->last[e] = now[e];
+  }
+}
+
+void HPC_done(GC_state s) {
+  if (NULL == s->procStates) {
+    HPC_chargePhase(s, s->profiling.phase);
+    return;
+  }
+  for (uint32_t proc = 0; proc < s->numberOfProcs; proc++) {
+    GC_state p = &(s->procStates[proc]);
+    HPC_chargePhase(p, p->profiling.phase);
+  }
+}
+
+#endif
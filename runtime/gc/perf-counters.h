@@ -0,0 +1,55 @@
+/** Hardware performance counters.
+  *
+  * With `@mpl perf-counters --`, each processor opens a group of counters on
+  * its own thread with perf_event_open: cycles, instructions, last-level
+  * cache misses and dTLB misses. They are read every time the processor
+  * switches between the mutator, local GC, promotion and CC (see
+  * setProfilePhase), and the difference is charged to the phase which just
+  * ended. Totals appear per processor in the JSON summary.
+  *
+  * Counters that the hardware (or the VM) does not support read as zero. If
+  * the group cannot be opened at all, e.g. because of
+  * /proc/sys/kernel/perf_event_paranoid, the processor runs without them.
+  */
+
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#if (defined (MLTON_GC_INTERNAL_TYPES))
+
+#if defined (__linux__)
+#define HAS_PERF_COUNTERS TRUE
+#else
+#define HAS_PERF_COUNTERS FALSE
+#endif
+
+COMPILE_TIME_ASSERT(GC_PERF_PHASES__is_PROFILE_PHASES,
+                    GC_PERF_PHASES == PROFILE_PHASES);
+
+struct HPC_counters {
+  int groupFd; /* -1 if this processor has no counters */
+  /* Position of each event in a read of the group, or -1 if unsupported. */
+  int32_t slot[GC_PERF_EVENTS];
+  uint32_t numOpen;
+  uint64_t last[GC_PERF_EVENTS];
+};
+
+#endif /* MLTON_GC_INTERNAL_TYPES */
+
+#if (defined (MLTON_GC_INTERNAL_FUNCS))
+
+void HPC_init(struct HPC_counters *counters);
+
+/* Open the counters of the calling processor, if enabled. */
+void HPC_initThread(GC_state s);
+
+/* Charge the events counted since the last call to `phase`. */
+void HPC_chargePhase(GC_state s, GC_profilePhase phase);
+
+/* Charge the events of every processor to its current phase. Called once at
+ * exit, before the summary is written. */
+void HPC_done(GC_state s);
+
+#endif /* MLTON_GC_INTERNAL_FUNCS */
+
+#endif /* PERF_COUNTERS_H_ */
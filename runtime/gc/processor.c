@@ -17,6 +17,10 @@ int32_t Proc_processorNumber (GC_state s) {
   return s->procNumber;
 }
 
+uint32_t Proc_numberOfStates (GC_state s) {
+  return s->numberOfProcs + s->controls->gcThreads;
+}
+
 void Proc_waitForInitialization (GC_state s) {
   size_t pcounter = 0;
   while (!Proc_beginInit) {
@@ -28,6 +32,10 @@ void Proc_waitForInitialization (GC_state s) {
   while (!Proc_isInitialized (s)) {
     GC_MayTerminateThreadRarely(s, &pcounter);
   }
+
+  /* processor 0 started its profiling timer and counters in GC_lateInit */
+  initProfilingThread (s);
+  HPC_initThread (s);
 }
 
 void Proc_signalInitialization (GC_state s) {
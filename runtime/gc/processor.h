@@ -10,6 +10,10 @@
 /* Unique number for this thread */
 int32_t Proc_processorNumber (GC_state s);
 
+/* Number of GC states: the processors, followed by the dedicated collector
+ * threads (@mpl gc-threads), which never run ML code. */
+uint32_t Proc_numberOfStates (GC_state s);
+
 /* Used to make sure all threads are properly initialized */
 void Proc_waitForInitialization (GC_state s);
 void Proc_signalInitialization (GC_state s);
@@ -317,7 +317,84 @@ void GC_profileWrite (GC_state s, GC_profileData p, NullString8_t fileName) {
   profileWrite (s, p, (const char*)fileName);
 }
 
-void setProfTimer (suseconds_t usec) {
+bool isTimeProfiling (GC_state s) {
+  return PROFILE_TIME_FIELD == s->profiling.kind
+    or PROFILE_TIME_LABEL == s->profiling.kind;
+}
+
+void mergeProfileData (GC_state s, GC_profileData into, GC_profileData from) {
+  uint32_t profileMasterLength =
+    s->sourceMaps.sourcesLength + s->sourceMaps.sourceNamesLength;
+
+  into->total += from->total;
+  into->totalGC += from->totalGC;
+  from->total = 0;
+  from->totalGC = 0;
+  for (GC_profileMasterIndex i = 0; i < profileMasterLength; i++) {
+    into->countTop[i] += from->countTop[i];
+    from->countTop[i] = 0;
+    if (s->profiling.stack) {
+      into->stack[i].ticks += from->stack[i].ticks;
+      into->stack[i].ticksGC += from->stack[i].ticksGC;
+      from->stack[i].ticks = 0;
+      from->stack[i].ticksGC = 0;
+    }
+  }
+}
+
+/* Fold the current data of every processor into that of processor 0, which
+ * is the data that gets written to mlmon.out. */
+void mergeProcessorProfiles (GC_state s) {
+  if (NULL == s->procStates)
+    return;
+
+  GC_state s0 = &(s->procStates[0]);
+  for (uint32_t proc = 1; proc < s->numberOfProcs; proc++) {
+    GC_state d = &(s->procStates[proc]);
+    if (NULL != d->profiling.data && d->profiling.data != s0->profiling.data)
+      mergeProfileData (s, s0->profiling.data, d->profiling.data);
+    for (int phase = 0; phase < PROFILE_PHASES; phase++) {
+      if (NULL != d->profiling.phaseData[phase])
+        mergeProfileData (s,
+                          s0->profiling.phaseData[phase],
+                          d->profiling.phaseData[phase]);
+    }
+  }
+}
+
+void finishProfileStack (GC_state s) {
+  GC_profileData p;
+  GC_profileMasterIndex profileMasterIndex;
+
+  p = s->profiling.data;
+  if (NULL == p or not s->profiling.stack)
+    return;
+  uint32_t profileMasterLength =
+    s->sourceMaps.sourcesLength + s->sourceMaps.sourceNamesLength;
+  for (profileMasterIndex = 0;
+       profileMasterIndex < profileMasterLength;
+       profileMasterIndex++) {
+    if (p->stack[profileMasterIndex].numOccurrences > 0) {
+      if (DEBUG_PROFILE)
+        fprintf (stderr, "done leaving %s\n",
+                 profileIndexSourceName (s, profileMasterIndex));
+      removeFromStackForProfiling (s, profileMasterIndex);
+    }
+  }
+}
+
+void setProfTimer (__attribute__ ((unused)) GC_state s, suseconds_t usec) {
+#if HAS_THREAD_PROF_TIMERS
+  struct itimerspec its;
+
+  if (not s->profiling.haveTimer)
+    return;
+  its.it_interval.tv_sec = 0;
+  its.it_interval.tv_nsec = 1000 * usec;
+  its.it_value = its.it_interval;
+  unless (0 == timer_settime (s->profiling.timer, 0, &its, NULL))
+    diee ("setProfTimer: timer_settime failed");
+#else
   struct itimerval iv;
 
   iv.it_interval.tv_sec = 0;
@@ -326,6 +403,29 @@ void setProfTimer (suseconds_t usec) {
   iv.it_value.tv_usec = usec;
   unless (0 == setitimer (ITIMER_PROF, &iv, NULL))
     die ("setProfTimer: setitimer failed");
+#endif
+}
+
+void setProfTimers (GC_state s, suseconds_t usec) {
+  if (NULL == s->procStates) {
+    setProfTimer (s, usec);
+    return;
+  }
+  for (uint32_t proc = 0; proc < s->numberOfProcs; proc++)
+    setProfTimer (&(s->procStates[proc]), usec);
+}
+
+void setProfilePhase (GC_state s, GC_profilePhase phase) {
+  if (PROFILE_PHASE_MUTATOR == s->profiling.phase
+      and NULL != s->profiling.phaseData[phase]) {
+    GC_frameIndex i = getCachedStackTopFrameIndex (s);
+    s->profiling.phaseSourceSeqIndex =
+      (i < s->frameInfosLength)
+      ? s->frameInfos[i].sourceSeqIndex
+      : UNKNOWN_SOURCE_SEQ_INDEX;
+  }
+  HPC_chargePhase (s, s->profiling.phase);
+  s->profiling.phase = phase;
 }
 
 #if not HAS_TIME_PROFILING
@@ -339,22 +439,36 @@ void initProfilingTime (__attribute__ ((unused)) GC_state s) {
   die ("no time profiling");
 }
 
-#else
+void initProfilingThread (__attribute__ ((unused)) GC_state s) {
+}
 
-static GC_state handleSigProfState;
+#else
 
 void GC_handleSigProf (code_pointer pc) {
   GC_frameIndex frameIndex;
   GC_state s;
   GC_sourceSeqIndex sourceSeqIndex;
+  GC_profilePhase phase;
 
-  s = handleSigProfState;
+  /* The signal is delivered to the thread whose timer expired, so this is
+   * the state of the processor which spent the time. */
+  s = pthread_getspecific (gcstate_key);
+  if (NULL == s or not s->profiling.isOn)
+    return;
 
   if (DEBUG_PROFILE)
     fprintf (stderr, "GC_handleSigProf ("FMTPTR") [%d]\n", (uintptr_t)pc,
              Proc_processorNumber (s));
-  if (s->amInGC)
+  phase = s->profiling.phase;
+  if (s->amInGC or PROFILE_PHASE_MUTATOR != phase) {
     sourceSeqIndex = GC_SOURCE_SEQ_INDEX;
+    if (NULL != s->profiling.phaseData[phase]) {
+      GC_profileData p = s->profiling.data;
+      s->profiling.data = s->profiling.phaseData[phase];
+      incForProfiling (s, 1, s->profiling.phaseSourceSeqIndex);
+      s->profiling.data = p;
+    }
+  }
   else {
     frameIndex = getCachedStackTopFrameIndex (s);
     /*
@@ -409,10 +523,35 @@ void GC_handleSigProf (code_pointer pc) {
 }
 
 void GC_profileDisable (void) {
-  setProfTimer (0);
+  setProfTimers (pthread_getspecific (gcstate_key), 0);
 }
 void GC_profileEnable (void) {
-  setProfTimer (10000);
+  setProfTimers (pthread_getspecific (gcstate_key), 10000);
+}
+
+void initProfilingThread (GC_state s) {
+  if (not s->profiling.isOn or not isTimeProfiling (s))
+    return;
+#if HAS_THREAD_PROF_TIMERS
+  struct sigevent sev;
+
+  memset (&sev, 0, sizeof (sev));
+  sev.sigev_notify = SIGEV_THREAD_ID;
+  sev.sigev_signo = SIGPROF;
+#ifdef sigev_notify_thread_id
+  sev.sigev_notify_thread_id = (pid_t)syscall (SYS_gettid);
+#else
+  sev._sigev_un._tid = (pid_t)syscall (SYS_gettid);
+#endif
+  unless (0 == timer_create (CLOCK_THREAD_CPUTIME_ID, &sev, &(s->profiling.timer)))
+    diee ("initProfilingThread: timer_create failed");
+  s->profiling.haveTimer = TRUE;
+  setProfTimer (s, 10000);
+#else
+  /* the one process-wide timer */
+  if (0 == s->procNumber)
+    setProfTimer (s, 10000);
+#endif
 }
 
 static void initProfilingTime (GC_state s) {
@@ -437,13 +576,13 @@ static void initProfilingTime (GC_state s) {
    * in order to have profiling cover as much as possible, you want it
    * to occur right after the sigaltstack() call.
    */
-  handleSigProfState = s;
   sigemptyset (&sa.sa_mask);
   GC_setSigProfHandler (&sa);
   unless (sigaction (SIGPROF, &sa, NULL) == 0)
     diee ("initProfilingTime: sigaction failed");
-  /* Start the SIGPROF timer. */
-  setProfTimer (10000);
+  /* Start the SIGPROF timer of this processor; the others start theirs in
+   * Proc_waitForInitialization. */
+  initProfilingThread (s);
 }
 
 #endif
@@ -463,10 +602,28 @@ void atexitForProfiling (void) {
   s = atexitForProfilingState;
   if (s->profiling.isOn) {
     fprintf (stderr, "profiling is on\n");
+    mergeProcessorProfiles (s);
     profileWrite (s, s->profiling.data, "mlmon.out");
   }
 }
 
+static void initPhaseProfiling (GC_state s) {
+  s->profiling.phase = PROFILE_PHASE_MUTATOR;
+  s->profiling.phaseSourceSeqIndex = UNKNOWN_SOURCE_SEQ_INDEX;
+  for (int phase = 0; phase < PROFILE_PHASES; phase++)
+    s->profiling.phaseData[phase] = NULL;
+#if HAS_THREAD_PROF_TIMERS
+  s->profiling.haveTimer = FALSE;
+#endif
+  if (s->profiling.isOn
+      and isTimeProfiling (s)
+      and s->controls->profileSplitGC) {
+    for (int phase = 0; phase < PROFILE_PHASES; phase++)
+      if (PROFILE_PHASE_MUTATOR != phase)
+        s->profiling.phaseData[phase] = profileMalloc (s);
+  }
+}
+
 void initProfiling (GC_state s) {
   if (PROFILE_NONE == s->profiling.kind)
     s->profiling.isOn = FALSE;
@@ -490,34 +647,55 @@ void initProfiling (GC_state s) {
     atexitForProfilingState = s;
     atexit (atexitForProfiling);
   }
+  initPhaseProfiling (s);
 }
 
+/* Give d its own profile data, so that processors never race on counts. */
+void duplicateProfiling (GC_state d, GC_state s) {
+  d->profiling.data = NULL;
+  if (d->profiling.isOn) {
+    d->profiling.data = profileMalloc (d);
+    if (PROFILE_TIME_FIELD == d->profiling.kind)
+      d->sourceMaps.curSourceSeqIndex = s->sourceMaps.curSourceSeqIndex;
+  }
+  initPhaseProfiling (d);
+}
+
+static const char *profilePhaseFileNames[PROFILE_PHASES] = {
+  NULL,
+  "mlmon.local-gc.out",
+  "mlmon.promotion.out",
+  "mlmon.cc.out",
+};
+
 void GC_profileDone (GC_state s) {
-  GC_profileData p;
-  GC_profileMasterIndex profileMasterIndex;
+  GC_state s0;
 
   if (DEBUG_PROFILE)
     fprintf (stderr, "GC_profileDone () [%d]\n",
              Proc_processorNumber (s));
   assert (s->profiling.isOn);
-  if (PROFILE_TIME_FIELD == s->profiling.kind
-      or PROFILE_TIME_LABEL == s->profiling.kind)
-    setProfTimer (0);
-  s->profiling.isOn = FALSE;
-  p = s->profiling.data;
-  if (s->profiling.stack) {
-    uint32_t profileMasterLength =
-      s->sourceMaps.sourcesLength + s->sourceMaps.sourceNamesLength;
-    for (profileMasterIndex = 0;
-         profileMasterIndex < profileMasterLength;
-         profileMasterIndex++) {
-      if (p->stack[profileMasterIndex].numOccurrences > 0) {
-        if (DEBUG_PROFILE)
-          fprintf (stderr, "done leaving %s\n",
-                   profileIndexSourceName (s, profileMasterIndex));
-        removeFromStackForProfiling (s, profileMasterIndex);
-      }
-    }
+  if (isTimeProfiling (s))
+    setProfTimers (s, 0);
+
+  if (NULL == s->procStates) {
+    s->profiling.isOn = FALSE;
+    finishProfileStack (s);
+    s0 = s;
+  } else {
+    for (uint32_t proc = 0; proc < s->numberOfProcs; proc++)
+      s->procStates[proc].profiling.isOn = FALSE;
+    for (uint32_t proc = 0; proc < s->numberOfProcs; proc++)
+      finishProfileStack (&(s->procStates[proc]));
+    mergeProcessorProfiles (s);
+    s0 = &(s->procStates[0]);
+  }
+
+  /* The mutator's profile is written to mlmon.out by MLtonProfile. */
+  for (int phase = 0; phase < PROFILE_PHASES; phase++) {
+    if (NULL != s0->profiling.phaseData[phase])
+      profileWrite (s, s0->profiling.phaseData[phase],
+                    profilePhaseFileNames[phase]);
   }
 }
 
@@ -65,11 +65,47 @@ typedef struct GC_profileData {
   uintmax_t totalGC;
 } *GC_profileData;
 
+/* What a processor is doing when a time profiling sample arrives. Samples
+ * outside of the mutator are charged to <gc> in the usual profile. */
+typedef enum {
+  PROFILE_PHASE_MUTATOR,
+  PROFILE_PHASE_LOCAL_GC,
+  PROFILE_PHASE_PROMOTION,
+  PROFILE_PHASE_CC,
+  PROFILE_PHASES
+} GC_profilePhase;
+
+/* On Linux, each processor has a timer on its own CPU time which delivers
+ * SIGPROF to that processor's thread, so that samples are charged to the
+ * processor which actually spent the time. Elsewhere, there is a single
+ * process-wide ITIMER_PROF, and samples go to whichever thread catches the
+ * signal.
+ */
+#if HAS_TIME_PROFILING && defined (__linux__)
+#define HAS_THREAD_PROF_TIMERS TRUE
+#else
+#define HAS_THREAD_PROF_TIMERS FALSE
+#endif
+
+/* Every processor has its own struct GC_profiling, with its own data. These
+ * are merged into the data of processor 0 by GC_profileDone.
+ */
 struct GC_profiling {
   GC_profileData data;
   bool isOn;
   GC_profileKind kind;
   bool stack;
+  volatile GC_profilePhase phase;
+  /* With profile-split-gc, time samples outside of the mutator are also
+   * charged, in phaseData[phase], to phaseSourceSeqIndex: the code which was
+   * running when the phase began.
+   */
+  GC_sourceSeqIndex phaseSourceSeqIndex;
+  GC_profileData phaseData[PROFILE_PHASES];
+#if HAS_THREAD_PROF_TIMERS
+  timer_t timer;
+  bool haveTimer;
+#endif
 };
 
 #else
@@ -108,10 +144,22 @@ PRIVATE GC_profileData profileMalloc (GC_state s);
 PRIVATE void profileWrite (GC_state s, GC_profileData p, const char* fileName);
 PRIVATE void profileFree (GC_state s, GC_profileData p);
 
-static void setProfTimer (suseconds_t usec);
+static inline bool isTimeProfiling (GC_state s);
+static void mergeProfileData (GC_state s, GC_profileData into, GC_profileData from);
+static void mergeProcessorProfiles (GC_state s);
+static void finishProfileStack (GC_state s);
+
+static void setProfTimer (GC_state s, suseconds_t usec);
+static void setProfTimers (GC_state s, suseconds_t usec);
 static void initProfilingTime (GC_state s);
 static void atexitForProfiling (void);
 static void initProfiling (GC_state s);
+static void duplicateProfiling (GC_state d, GC_state s);
+/* Start sampling the calling thread, which must be the one running s. */
+static void initProfilingThread (GC_state s);
+
+/* Also charges the hardware counters (perf-counters.h) to the phase ending. */
+static inline void setProfilePhase (GC_state s, GC_profilePhase phase);
 
 #endif /* (defined (MLTON_GC_INTERNAL_FUNCS)) */
 
@@ -77,6 +77,11 @@ pointer sequenceAllocateInHH(GC_state s,
       result + sequenceSizeAligned);
     sequenceChunk->mightContainMultipleObjects = FALSE;
 
+    /* if the heap profiler decided to sample the next object, then that is
+     * this sequence */
+    if (NULL != thread->currentChunk->heapSamples)
+      HP_moveSample(thread->currentChunk, s->frontier, sequenceChunk, result);
+
     assert(s->frontier == HM_HH_getFrontier(thread));
     s->limitPlusSlop = HM_HH_getLimit(thread);
     s->limit = s->limitPlusSlop - GC_HEAP_LIMIT_SLOP;
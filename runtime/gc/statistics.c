@@ -19,6 +19,24 @@ void outputSyncStatisticsJSON(FILE* out,
                               const char* type,
                               uintmax_t num);
 
+void outputSchedulerStatisticsJSON(FILE* out,
+                                   struct GC_schedulerStatistics* sched);
+
+void outputPerfStatisticsJSON(FILE* out,
+                              struct GC_perfStatistics* perf);
+
+static uint32_t pauseBucketOf(uint64_t nanoseconds);
+static void* statisticsSnapshotLoop(void* arg);
+static uintmax_t timespecToMillis(struct timespec *t);
+
+/* State shared by the snapshot thread and the final snapshot in GC_done. */
+static struct {
+  pthread_mutex_t lock;
+  struct timespec start;
+  struct timespec last;
+  uintmax_t *lastBytesAllocated;
+} S_snapshots = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
 /************************/
 /* Function Definitions */
 /************************/
@@ -27,6 +45,7 @@ struct GC_globalCumulativeStatistics* newGlobalCumulativeStatistics(void) {
   struct GC_globalCumulativeStatistics* stats;
 
   stats = malloc(sizeof(struct GC_globalCumulativeStatistics));
+  stats->currentHeapOccupancy = 0;
   stats->maxHeapOccupancy = 0;
 
   return stats;
@@ -49,6 +68,13 @@ struct GC_cumulativeStatistics *newCumulativeStatistics(void) {
   cumulativeStatistics->bytesReclaimedByLocal = 0;
   cumulativeStatistics->bytesReclaimedByRootCC = 0;
   cumulativeStatistics->bytesReclaimedByInternalCC = 0;
+  cumulativeStatistics->bytesRetainedByRootCC = 0;
+  cumulativeStatistics->bytesRetainedByInternalCC = 0;
+  cumulativeStatistics->bytesFragmentedByRootCC = 0;
+  cumulativeStatistics->bytesFragmentedByInternalCC = 0;
+  cumulativeStatistics->bytesRecycledByRootCC = 0;
+  cumulativeStatistics->bytesStackScanSkipped = 0;
+  cumulativeStatistics->bytesKeptInPlaceByLocal = 0;
   cumulativeStatistics->maxBytesLive = 0;
   cumulativeStatistics->maxBytesLiveSinceReset = 0;
   cumulativeStatistics->maxHeapSize = 0;
@@ -79,6 +105,21 @@ struct GC_cumulativeStatistics *newCumulativeStatistics(void) {
   cumulativeStatistics->timeInternalCC.tv_sec = 0;
   cumulativeStatistics->timeInternalCC.tv_nsec = 0;
 
+  cumulativeStatistics->sched.numSteals = 0;
+  cumulativeStatistics->sched.numFailedSteals = 0;
+  cumulativeStatistics->sched.numTasksExecuted = 0;
+  cumulativeStatistics->sched.maxDequeDepth = 0;
+  cumulativeStatistics->sched.firstStealNanoseconds = 0;
+  cumulativeStatistics->sched.idleNanoseconds = 0;
+  for (size_t i = 0; i < GC_SCHED_IDLE_BUCKETS; i++) {
+    cumulativeStatistics->sched.idleHistogram[i] = 0;
+  }
+  cumulativeStatistics->sched.numStealsFromProc = NULL;
+  cumulativeStatistics->sched.numStealsFromProcLength = 0;
+
+  memset(cumulativeStatistics->pauses, 0, sizeof(cumulativeStatistics->pauses));
+  memset(&(cumulativeStatistics->perf), 0, sizeof(cumulativeStatistics->perf));
+
   rusageZero (&cumulativeStatistics->ru_gc);
   rusageZero (&cumulativeStatistics->ru_gcCopying);
   rusageZero (&cumulativeStatistics->ru_gcMarkCompact);
@@ -91,6 +132,19 @@ struct GC_cumulativeStatistics *newCumulativeStatistics(void) {
   return cumulativeStatistics;
 }
 
+/* The number of processors isn't known yet when the main processor's
+ * statistics are created, so the per-victim steal counts are allocated
+ * separately, once it is. */
+void initSchedulerStatistics(struct GC_cumulativeStatistics* statistics,
+                             uint32_t numberOfProcs) {
+  statistics->sched.numStealsFromProc =
+    calloc(numberOfProcs, sizeof(uint64_t));
+  if (NULL == statistics->sched.numStealsFromProc) {
+    DIE("failed to allocate scheduler statistics");
+  }
+  statistics->sched.numStealsFromProcLength = numberOfProcs;
+}
+
 struct GC_lastMajorStatistics *newLastMajorStatistics(void) {
   struct GC_lastMajorStatistics *lastMajorStatistics;
 
@@ -219,6 +273,60 @@ void S_outputCumulativeStatisticsJSON(
 
     fprintf(out, ", ");
 
+    fprintf(out,
+            "\"bytesReclaimedByRootCC\" : %"PRIuMAX,
+            statistics->bytesReclaimedByRootCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesRetainedByRootCC\" : %"PRIuMAX,
+            statistics->bytesRetainedByRootCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesFragmentedByRootCC\" : %"PRIuMAX,
+            statistics->bytesFragmentedByRootCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesRecycledByRootCC\" : %"PRIuMAX,
+            statistics->bytesRecycledByRootCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesStackScanSkipped\" : %"PRIuMAX,
+            statistics->bytesStackScanSkipped);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesKeptInPlaceByLocal\" : %"PRIuMAX,
+            statistics->bytesKeptInPlaceByLocal);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesReclaimedByInternalCC\" : %"PRIuMAX,
+            statistics->bytesReclaimedByInternalCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesRetainedByInternalCC\" : %"PRIuMAX,
+            statistics->bytesRetainedByInternalCC);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"bytesFragmentedByInternalCC\" : %"PRIuMAX,
+            statistics->bytesFragmentedByInternalCC);
+
+    fprintf(out, ", ");
+
     fprintf(out, "\"maxGlobalHeapBytesLive\" : %"PRIuMAX, statistics->maxBytesLive);
 
     fprintf(out, ", ");
@@ -254,10 +362,203 @@ void S_outputCumulativeStatisticsJSON(
     fprintf(out, ", ");
 
     fprintf(out, "\"bytesHashConsed\" : %"PRIuMAX, statistics->bytesHashConsed);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"scheduler\" : ");
+    outputSchedulerStatisticsJSON(out, &statistics->sched);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"pauses\" : ");
+    S_outputPauseStatisticsJSON(out, statistics->pauses);
+
+    if (statistics->perf.enabled) {
+      fprintf(out, ", ");
+
+      fprintf(out, "\"perfCounters\" : ");
+      outputPerfStatisticsJSON(out, &statistics->perf);
+    }
+  }
+  fprintf(out, " }");
+}
+
+void S_recordPause(GC_state s, enum GC_pauseKind kind,
+                   struct timespec *duration) {
+  struct GC_cumulativeStatistics* stats = s->cumulativeStatistics;
+  struct GC_pauseHistogram* h = &(stats->pauses[kind]);
+  uint64_t nanoseconds =
+    (uint64_t)duration->tv_sec * 1000000000ULL + (uint64_t)duration->tv_nsec;
+
+  assert(kind < GC_PAUSE_KINDS);
+  h->count++;
+  h->buckets[pauseBucketOf(nanoseconds)]++;
+
+  if (nanoseconds / 1000000 > stats->maxPauseTime)
+    stats->maxPauseTime = nanoseconds / 1000000;
+}
+
+void S_mergePauseHistogram(struct GC_pauseHistogram* dst,
+                           struct GC_pauseHistogram* src) {
+  dst->count += src->count;
+  for (uint32_t i = 0; i < GC_PAUSE_BUCKETS; i++)
+    dst->buckets[i] += src->buckets[i];
+}
+
+uint64_t S_pauseBucketBound(uint32_t bucket) {
+  const uint32_t subBuckets = 1 << GC_PAUSE_SUB_BITS;
+  uint32_t next = bucket + 1;
+
+  assert(bucket < GC_PAUSE_BUCKETS);
+  if (next < subBuckets)
+    return next;
+
+  /* next = (exponent - GC_PAUSE_SUB_BITS + 1) * subBuckets + sub */
+  uint32_t exponent = next / subBuckets + GC_PAUSE_SUB_BITS - 1;
+  uint64_t sub = next % subBuckets;
+  return (subBuckets + sub) << (exponent - GC_PAUSE_SUB_BITS);
+}
+
+uint64_t S_pausePercentile(struct GC_pauseHistogram* h, double q) {
+  if (0 == h->count)
+    return 0;
+
+  /* the rank of the quantile, counting from 1 */
+  uint64_t rank = (uint64_t)(q * (double)h->count + 0.5);
+  if (rank < 1) rank = 1;
+  if (rank > h->count) rank = h->count;
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < GC_PAUSE_BUCKETS; i++) {
+    seen += h->buckets[i];
+    if (seen >= rank)
+      return S_pauseBucketBound(i);
+  }
+  return S_pauseBucketBound(GC_PAUSE_BUCKETS - 1);
+}
+
+void S_outputPauseStatisticsJSON(FILE* out,
+                                 struct GC_pauseHistogram* pauses) {
+  static const char* names[GC_PAUSE_KINDS] =
+    { "localGC", "promo", "rootCC", "internalCC" };
+
+  fprintf(out, "{ ");
+  for (uint32_t k = 0; k < GC_PAUSE_KINDS; k++) {
+    struct GC_pauseHistogram* h = &(pauses[k]);
+    fprintf(out, "%s\"%s\" : { ", (k == 0 ? "" : ", "), names[k]);
+    fprintf(out, "\"count\" : %"PRIu64, h->count);
+    fprintf(out, ", \"p50\" : %"PRIu64, S_pausePercentile(h, 0.5));
+    fprintf(out, ", \"p99\" : %"PRIu64, S_pausePercentile(h, 0.99));
+    fprintf(out, ", \"p999\" : %"PRIu64, S_pausePercentile(h, 0.999));
+    fprintf(out, " }");
   }
   fprintf(out, " }");
 }
 
+void S_addHeapOccupancy(GC_state s, size_t bytes) {
+  struct GC_globalCumulativeStatistics* stats = s->globalCumulativeStatistics;
+  size_t now = __sync_add_and_fetch(&(stats->currentHeapOccupancy), bytes);
+  size_t max = stats->maxHeapOccupancy;
+  while (now > max
+         && !__sync_bool_compare_and_swap(&(stats->maxHeapOccupancy), max, now))
+  {
+    max = stats->maxHeapOccupancy;
+  }
+}
+
+void S_removeHeapOccupancy(GC_state s, size_t bytes) {
+  __sync_sub_and_fetch(&(s->globalCumulativeStatistics->currentHeapOccupancy),
+                       bytes);
+}
+
+void S_startStatisticsSnapshots(GC_state s) {
+  pthread_t snapshotter;
+
+  assert(s->controls->statsInterval > 0);
+  assert(s->controls->statsFile != NULL);
+
+  S_snapshots.lastBytesAllocated =
+    calloc(s->numberOfProcs, sizeof(*S_snapshots.lastBytesAllocated));
+  if (NULL == S_snapshots.lastBytesAllocated)
+    DIE("could not allocate statistics snapshot state");
+  timespec_now(&S_snapshots.start);
+  S_snapshots.last = S_snapshots.start;
+
+  if (0 != pthread_create(&snapshotter, NULL, statisticsSnapshotLoop, s))
+    DIE("could not start statistics snapshot thread");
+  pthread_detach(snapshotter);
+}
+
+/* Appends one line describing the whole program to statsFile. The counters
+ * are read without synchronizing with the processors updating them, so a
+ * snapshot is only approximately consistent, which is fine for monitoring.
+ */
+void S_outputStatisticsSnapshotJSON(GC_state s) {
+  FILE* out = s->controls->statsFile;
+  struct timespec now;
+  struct timespec sinceStart;
+  struct timespec sinceLast;
+  uintmax_t totalAllocated = 0;
+  uintmax_t totalDelta = 0;
+  double seconds;
+
+  pthread_mutex_lock(&S_snapshots.lock);
+  if (NULL == S_snapshots.lastBytesAllocated) {
+    /* snapshots were never started */
+    pthread_mutex_unlock(&S_snapshots.lock);
+    return;
+  }
+
+  timespec_now(&now);
+  sinceStart = now;
+  timespec_sub(&sinceStart, &S_snapshots.start);
+  sinceLast = now;
+  timespec_sub(&sinceLast, &S_snapshots.last);
+  S_snapshots.last = now;
+  seconds = (double)sinceLast.tv_sec + (double)sinceLast.tv_nsec / 1e9;
+  if (seconds <= 0.0)
+    seconds = 1e-9;
+
+  fprintf(out, "{ \"time\" : %"PRIuMAX, timespecToMillis(&sinceStart));
+  fprintf(out, ", \"heapOccupancy\" : %zu",
+          s->globalCumulativeStatistics->currentHeapOccupancy);
+  fprintf(out, ", \"maxHeapOccupancy\" : %zu",
+          s->globalCumulativeStatistics->maxHeapOccupancy);
+  fprintf(out, ", \"procs\" : [");
+  for (uint32_t p = 0; p < s->numberOfProcs; p++) {
+    struct GC_cumulativeStatistics* stats =
+      s->procStates[p].cumulativeStatistics;
+    uintmax_t allocated = stats->bytesAllocated;
+    uintmax_t delta = allocated - S_snapshots.lastBytesAllocated[p];
+    S_snapshots.lastBytesAllocated[p] = allocated;
+    totalAllocated += allocated;
+    totalDelta += delta;
+
+    fprintf(out, "%s{ ", (p == 0 ? "" : ", "));
+    fprintf(out, "\"bytesAllocated\" : %"PRIuMAX, allocated);
+    fprintf(out, ", \"allocationRate\" : %.0f", (double)delta / seconds);
+    fprintf(out, ", \"numLocalGCs\" : %"PRIuMAX, stats->numHHLocalGCs);
+    fprintf(out, ", \"localGCTime\" : %"PRIuMAX,
+            timespecToMillis(&(stats->timeLocalGC)));
+    fprintf(out, ", \"promoTime\" : %"PRIuMAX,
+            timespecToMillis(&(stats->timeLocalPromo)));
+    fprintf(out, ", \"numRootCCs\" : %"PRIuMAX, stats->numRootCCs);
+    fprintf(out, ", \"rootCCTime\" : %"PRIuMAX,
+            timespecToMillis(&(stats->timeRootCC)));
+    fprintf(out, ", \"numInternalCCs\" : %"PRIuMAX, stats->numInternalCCs);
+    fprintf(out, ", \"internalCCTime\" : %"PRIuMAX,
+            timespecToMillis(&(stats->timeInternalCC)));
+    fprintf(out, " }");
+  }
+  fprintf(out, "]");
+  fprintf(out, ", \"bytesAllocated\" : %"PRIuMAX, totalAllocated);
+  fprintf(out, ", \"allocationRate\" : %.0f", (double)totalDelta / seconds);
+  fprintf(out, " }\n");
+  fflush(out);
+
+  pthread_mutex_unlock(&S_snapshots.lock);
+}
+
 /*******************************/
 /* Static Function Definitions */
 /*******************************/
@@ -301,3 +602,109 @@ void outputSyncStatisticsJSON(FILE* out,
   }
   fprintf(out, " }");
 }
+
+void outputPerfStatisticsJSON(FILE* out,
+                              struct GC_perfStatistics* perf) {
+  static const char *phaseNames[GC_PERF_PHASES] =
+    {"mutator", "localGC", "promotion", "cc"};
+
+  fprintf(out, "{ ");
+  for (uint32_t phase = 0; phase < GC_PERF_PHASES; phase++) {
+    uint64_t *counts = perf->counts[phase];
+
+    fprintf(out, "%s\"%s\" : { ", (phase == 0 ? "" : ", "), phaseNames[phase]);
+    fprintf(out, "\"cycles\" : %"PRIu64, counts[GC_PERF_CYCLES]);
+    fprintf(out, ", ");
+    fprintf(out, "\"instructions\" : %"PRIu64, counts[GC_PERF_INSTRUCTIONS]);
+    fprintf(out, ", ");
+    fprintf(out, "\"llcMisses\" : %"PRIu64, counts[GC_PERF_LLC_MISSES]);
+    fprintf(out, ", ");
+    fprintf(out, "\"dtlbMisses\" : %"PRIu64, counts[GC_PERF_DTLB_MISSES]);
+    fprintf(out, " }");
+  }
+  fprintf(out, " }");
+}
+
+void outputSchedulerStatisticsJSON(FILE* out,
+                                   struct GC_schedulerStatistics* sched) {
+  fprintf(out, "{ ");
+  {
+    fprintf(out, "\"numSteals\" : %"PRIu64, sched->numSteals);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"numFailedSteals\" : %"PRIu64, sched->numFailedSteals);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"numTasksExecuted\" : %"PRIu64, sched->numTasksExecuted);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"maxDequeDepth\" : %"PRIu64, sched->maxDequeDepth);
+
+    fprintf(out, ", ");
+
+    fprintf(out,
+            "\"firstStealNanoseconds\" : %"PRIu64,
+            sched->firstStealNanoseconds);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"idleNanoseconds\" : %"PRIu64, sched->idleNanoseconds);
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"idleHistogram\" : [");
+    for (size_t i = 0; i < GC_SCHED_IDLE_BUCKETS; i++) {
+      fprintf(out, "%s%"PRIu64, (i == 0 ? "" : ", "), sched->idleHistogram[i]);
+    }
+    fprintf(out, "]");
+
+    fprintf(out, ", ");
+
+    fprintf(out, "\"numStealsFromProc\" : [");
+    for (uint32_t p = 0; p < sched->numStealsFromProcLength; p++) {
+      fprintf(out, "%s%"PRIu64, (p == 0 ? "" : ", "), sched->numStealsFromProc[p]);
+    }
+    fprintf(out, "]");
+  }
+  fprintf(out, " }");
+}
+
+void* statisticsSnapshotLoop(void* arg) {
+  GC_state s = (GC_state)arg;
+  uint32_t interval = s->controls->statsInterval;
+  struct timespec delay;
+
+  delay.tv_sec = interval / 1000;
+  delay.tv_nsec = (long)(interval % 1000) * 1000L * 1000L;
+
+  while (TRUE) {
+    /* on EINTR, just take the snapshot a little early */
+    nanosleep(&delay, NULL);
+    S_outputStatisticsSnapshotJSON(s);
+  }
+  return NULL;
+}
+
+uintmax_t timespecToMillis(struct timespec *t) {
+  return (uintmax_t)t->tv_sec * 1000 + (uintmax_t)t->tv_nsec / 1000000;
+}
+
+/* Bucket b < 2^GC_PAUSE_SUB_BITS holds exactly b. Otherwise, with
+ * e = floor(log2(n)), n is in bucket (e - GC_PAUSE_SUB_BITS + 1) * 2^SUB
+ * plus the GC_PAUSE_SUB_BITS bits of n just below its leading one. */
+uint32_t pauseBucketOf(uint64_t nanoseconds) {
+  const uint32_t subBuckets = 1 << GC_PAUSE_SUB_BITS;
+
+  if (nanoseconds < subBuckets)
+    return (uint32_t)nanoseconds;
+  if (nanoseconds >= ((uint64_t)1 << GC_PAUSE_MAX_BITS))
+    return GC_PAUSE_BUCKETS - 1;
+
+  uint32_t exponent = 63 - __builtin_clzll(nanoseconds);
+  uint32_t sub =
+    (uint32_t)(nanoseconds >> (exponent - GC_PAUSE_SUB_BITS)) & (subBuckets - 1);
+  return (exponent - GC_PAUSE_SUB_BITS + 1) * subBuckets + sub;
+}
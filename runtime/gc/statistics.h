@@ -21,7 +21,75 @@ enum {
   SYNC_SAVE_WORLD,
 };
 
+#define GC_SCHED_IDLE_BUCKETS 32
+
+/* Per-processor counters maintained by the scheduler. The scheduler writes
+ * the leading fields directly (see the SCHEDULER STATISTICS section of
+ * Scheduler.sml), so their order must stay in sync with the offsets used
+ * there.
+ */
+struct GC_schedulerStatistics {
+  uint64_t numSteals;
+  uint64_t numFailedSteals;
+  uint64_t numTasksExecuted;
+  uint64_t maxDequeDepth;
+  uint64_t firstStealNanoseconds; /* since scheduler start; 0 if none yet */
+  uint64_t idleNanoseconds;
+  /* idleHistogram[i] counts idle periods of length in [2^(i-1), 2^i) us,
+   * with idleHistogram[0] counting those shorter than 1us. */
+  uint64_t idleHistogram[GC_SCHED_IDLE_BUCKETS];
+
+  /* numStealsFromProc[p] counts successful steals from processor p. */
+  uint64_t *numStealsFromProc;
+  uint32_t numStealsFromProcLength;
+};
+
+/* Pause times are recorded in log-linear (HDR-style) histograms of
+ * nanoseconds. Durations below 2^GC_PAUSE_SUB_BITS each get a bucket; above
+ * that, every power of two is split into 2^GC_PAUSE_SUB_BITS equal buckets,
+ * so a bucket's bounds are within 12.5% of each other. Durations of
+ * 2^GC_PAUSE_MAX_BITS ns (about 18 minutes) or more go in the last bucket.
+ * MPLGC (basis-library/mpl/gc.sml) relies on this layout.
+ */
+#define GC_PAUSE_SUB_BITS 3
+#define GC_PAUSE_MAX_BITS 40
+#define GC_PAUSE_BUCKETS \
+  ((GC_PAUSE_MAX_BITS - GC_PAUSE_SUB_BITS + 1) << GC_PAUSE_SUB_BITS)
+
+enum GC_pauseKind {
+  GC_PAUSE_LOCAL_GC = 0,
+  GC_PAUSE_PROMO,
+  GC_PAUSE_ROOT_CC,
+  GC_PAUSE_INTERNAL_CC,
+  GC_PAUSE_KINDS
+};
+
+struct GC_pauseHistogram {
+  uint64_t count;
+  uint64_t buckets[GC_PAUSE_BUCKETS];
+};
+
+/* Hardware performance counters (see perf-counters.h), as counted while a
+ * processor was in each phase: the mutator, local GC, promotion, or CC
+ * (GC_profilePhase, in profiling.h).
+ */
+enum GC_perfEvent {
+  GC_PERF_CYCLES = 0,
+  GC_PERF_INSTRUCTIONS,
+  GC_PERF_LLC_MISSES,
+  GC_PERF_DTLB_MISSES,
+  GC_PERF_EVENTS
+};
+
+#define GC_PERF_PHASES 4
+
+struct GC_perfStatistics {
+  bool enabled; /* whether the counters could be opened on this processor */
+  uint64_t counts[GC_PERF_PHASES][GC_PERF_EVENTS];
+};
+
 struct GC_globalCumulativeStatistics {
+  size_t currentHeapOccupancy; /* bytes of chunks currently mapped */
   size_t maxHeapOccupancy;
 };
 
@@ -38,6 +106,18 @@ struct GC_cumulativeStatistics {
   uintmax_t bytesReclaimedByLocal;
   uintmax_t bytesReclaimedByRootCC;
   uintmax_t bytesReclaimedByInternalCC;
+  /* Chunk bytes kept by CC, and how many of those were in free lines,
+   * summed over collections. */
+  uintmax_t bytesRetainedByRootCC;
+  uintmax_t bytesRetainedByInternalCC;
+  uintmax_t bytesFragmentedByRootCC;
+  uintmax_t bytesFragmentedByInternalCC;
+  /* Free bytes of root heap chunks handed back to the mutator. */
+  uintmax_t bytesRecycledByRootCC;
+  /* Stack bytes below a watermark, not scanned by local collections. */
+  uintmax_t bytesStackScanSkipped;
+  /* Live bytes in chunks kept in place by `local-gc compact`. */
+  uintmax_t bytesKeptInPlaceByLocal;
 
   size_t maxBytesLive;
   size_t maxBytesLiveSinceReset;
@@ -72,6 +152,12 @@ struct GC_cumulativeStatistics {
   struct timespec timeRootCC;
   struct timespec timeInternalCC;
 
+  struct GC_schedulerStatistics sched;
+
+  struct GC_pauseHistogram pauses[GC_PAUSE_KINDS];
+
+  struct GC_perfStatistics perf;
+
   struct rusage ru_gc; /* total resource usage in gc. */
   struct rusage ru_gcCopying; /* resource usage in major copying gcs. */
   struct rusage ru_gcMarkCompact; /* resource usage in major mark-compact gcs. */
@@ -98,8 +184,31 @@ struct GC_lastMajorStatistics {
 struct GC_globalCumulativeStatistics* newGlobalCumulativeStatistics(void);
 struct GC_cumulativeStatistics* newCumulativeStatistics(void);
 struct GC_lastMajorStatistics* newLastMajorStatistics(void);
+void initSchedulerStatistics(struct GC_cumulativeStatistics* statistics,
+                             uint32_t numberOfProcs);
 
 void S_outputCumulativeStatisticsJSON(
     FILE* out, struct GC_cumulativeStatistics* statistics);
 
+/* Records one pause of the given kind, which took `duration`. */
+void S_recordPause(GC_state s, enum GC_pauseKind kind,
+                   struct timespec *duration);
+void S_mergePauseHistogram(struct GC_pauseHistogram* dst,
+                           struct GC_pauseHistogram* src);
+/* The exclusive upper bound, in nanoseconds, of the given bucket. */
+uint64_t S_pauseBucketBound(uint32_t bucket);
+/* An upper bound on the q-quantile (0 <= q <= 1) of the histogram, in
+ * nanoseconds, or 0 if it is empty. */
+uint64_t S_pausePercentile(struct GC_pauseHistogram* h, double q);
+void S_outputPauseStatisticsJSON(FILE* out,
+                                 struct GC_pauseHistogram* pauses);
+
+void S_addHeapOccupancy(GC_state s, size_t bytes);
+void S_removeHeapOccupancy(GC_state s, size_t bytes);
+
+/* Periodic snapshots, enabled by @mpl stats-interval. Starting them spawns a
+ * thread which appends a line to s->controls->statsFile every interval. */
+void S_startStatisticsSnapshots(GC_state s);
+void S_outputStatisticsSnapshotJSON(GC_state s);
+
 #endif /* (defined (MLTON_GC_INTERNAL_FUNCS)) */
@@ -36,6 +36,9 @@ void switchToThread(GC_state s, objptr op) {
 
   s->currentThread = op;
   setGCStateCurrentThreadAndStack (s);
+  /* the watermarks and nursery were for another thread */
+  clearStackWatermarks(s, 0);
+  s->nurseryLeaf = NULL;
 }
 
 void GC_switchToThread (GC_state s, pointer p, size_t ensureBytesFree) {
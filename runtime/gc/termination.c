@@ -21,6 +21,7 @@ void GC_TerminateThread(GC_state s) {
   getStackCurrent(s)->used = sizeofGCStateCurrentStackUsed (s);
   getThreadCurrent(s)->exnStack = s->exnStack;
   Trace0(EVENT_RUNTIME_LEAVE);
+  L_flushBinaryLog(s);
   pthread_exit(NULL);
 }
 
@@ -30,6 +30,18 @@ void GC_HH_setDepth(pointer threadp, Word32 depth) {
   GC_thread thread = threadObjptrToStruct(s, pointerToObjptr(threadp, NULL));
 
   assert(thread != NULL);
+  /* Joins only ever leave one depth at a time. Leaving more means that a
+   * join was skipped, and the heaps of the skipped depths would be lost. */
+  if (depth + 1 < thread->currentDepth) {
+    DIE("thread moved from depth %u to %u, skipping a join",
+        thread->currentDepth, depth);
+  }
+  if (thread == getThreadCurrent(s)) {
+    clearStackWatermarks(s, min(depth, thread->currentDepth));
+    if (depth >= 2 && depth == thread->currentDepth + 1)
+      recordStackWatermark(s, depth);
+    s->nurseryLeaf = NULL;
+  }
   thread->currentDepth = depth;
   // printf("%s %d\n", "setting thread depth to ", depth);
   // printf("%s %d\n", "HH depth = ", thread->hierarchicalHeap->depth);
@@ -108,6 +120,8 @@ void GC_HH_mergeThreads(pointer threadp, pointer childp) {
    */
   assert(getHierarchicalHeapCurrent(s) == thread->hierarchicalHeap);
 
+  /* the child's chunks were not tenured in this heap */
+  s->nurseryLeaf = NULL;
   HM_HH_merge(s, thread, child);
 }
 
@@ -192,6 +206,38 @@ size_t offsetofThread (GC_state s) {
   return (sizeofThread (s)) - (GC_NORMAL_METADATA_SIZE + sizeof (struct GC_thread));
 }
 
+void clearStackWatermarks(GC_state s, uint32_t depth) {
+  for (uint32_t d = depth+1; d < GC_STACK_WATERMARK_DEPTHS; d++)
+    s->stackWatermarks[d] = 0;
+}
+
+size_t getStackWatermark(GC_state s, uint32_t depth) {
+  if (depth >= GC_STACK_WATERMARK_DEPTHS)
+    return 0;
+  return s->stackWatermarks[depth];
+}
+
+/* The runtime call has just written back s->stackTop, so the top frame is
+ * the one which called GC_HH_setDepth. If the stack has no more than
+ * GC_STACK_WATERMARK_FRAMES frames, the watermark stays unknown. */
+void recordStackWatermark(GC_state s, uint32_t depth) {
+  if (depth >= GC_STACK_WATERMARK_DEPTHS)
+    return;
+
+  pointer top = s->stackTop;
+  for (uint32_t i = 0; i < GC_STACK_WATERMARK_FRAMES; i++) {
+    if (top <= s->stackBottom) {
+      s->stackWatermarks[depth] = 0;
+      return;
+    }
+    GC_returnAddress ra = *((GC_returnAddress*)(top - GC_RETURNADDRESS_SIZE));
+    GC_frameInfo frameInfo = getFrameInfoFromReturnAddress(s, ra);
+    assert(top - frameInfo->size >= s->stackBottom);
+    top -= frameInfo->size;
+  }
+  s->stackWatermarks[depth] = (size_t)(top - s->stackBottom);
+}
+
 static inline GC_thread threadObjptrToStruct(GC_state s, objptr threadObjptr) {
   if (BOGUS_OBJPTR == threadObjptr) {
     return NULL;
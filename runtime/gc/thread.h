@@ -73,6 +73,21 @@ COMPILE_TIME_ASSERT(GC_thread__packed,
 
 #define BOGUS_EXN_STACK ((ptrdiff_t)(-1))
 
+/* Stack watermarks of the current thread, one per fork depth, kept in the
+ * GC_state of the processor (see GC_HH_setDepth).
+ *
+ * When the current thread has forked into depth d, the frames which were
+ * pushed before the fork can only point into depths < d. If they also stay
+ * untouched until the thread joins back out of d, a local collection whose
+ * scope starts at d never needs to scan them: stackWatermarks[d] is the
+ * offset (from the bottom of the stack) of the lowest frame that it must
+ * scan. Zero means unknown, in which case the whole stack is scanned.
+ * Changing the depth of the thread forgets the watermarks of the depths it
+ * is no longer in, as does switching threads.
+ */
+#define GC_STACK_WATERMARK_DEPTHS 64
+#define GC_STACK_WATERMARK_FRAMES 3
+
 #else
 
 struct GC_thread;
@@ -84,6 +99,15 @@ typedef struct GC_thread *GC_thread;
 
 PRIVATE Word32 GC_HH_getDepth(pointer thread);
 PRIVATE void GC_HH_setDepth(pointer thread, Word32 depth);
+
+/* Moving the current thread one level deeper (to a depth of at least 2) also
+ * records the stack watermark of the new depth: the bottom of the
+ * GC_STACK_WATERMARK_FRAMES-th frame from the top. Local collections of the
+ * new depth skip everything below it, so the frame which will join back out
+ * of the depth must be among those top frames, i.e. the caller of the fork
+ * function which calls HH.setDepth (counting one frame for the HH wrapper).
+ * The frames below it must not run again until the join.
+ */
 PRIVATE void GC_HH_mergeThreads(pointer threadp, pointer childp);
 PRIVATE void GC_HH_promoteChunks(pointer thread);
 PRIVATE void GC_HH_setMinLocalCollectionDepth(pointer thread, Word32 depth);
@@ -113,6 +137,14 @@ static inline size_t offsetofThread (GC_state s);
  */
 static inline GC_thread threadObjptrToStruct(GC_state s, objptr threadObjptr);
 
+/* Forget the stack watermarks of all depths greater than `depth`. */
+static inline void clearStackWatermarks(GC_state s, uint32_t depth);
+
+/* The stack watermark of `depth` for the current thread, or 0 if unknown. */
+static inline size_t getStackWatermark(GC_state s, uint32_t depth);
+
+static inline void recordStackWatermark(GC_state s, uint32_t depth);
+
 #endif /* (defined (MLTON_GC_INTERNAL_FUNCS)) */
 
 #endif /* THREAD_H_ */
@@ -60,6 +60,20 @@ enum EventKind {
   EVENT_MERGED_HEAP           = 32,
 
   EVENT_COPY                  = 33,
+
+  EVENT_STEAL                 = 34,
+  EVENT_TASK_START            = 35,
+  EVENT_TASK_FINISH           = 36,
+  EVENT_DEQUE_DEPTH           = 37,
+
+  EVENT_CC_ROOT_ENTER         = 38,
+  EVENT_CC_ROOT_LEAVE         = 39,
+  EVENT_CC_INTERNAL_ENTER     = 40,
+  EVENT_CC_INTERNAL_LEAVE     = 41,
+
+  EVENT_EBR_EPOCH_ADVANCE     = 42,
+
+  EVENT_CHUNK_MMAP            = 43,
 };
 
 #define EventKindCount (sizeof EventKindStrings / sizeof *EventKindStrings)
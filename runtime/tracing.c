@@ -7,23 +7,154 @@
 #include <sys/time.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <semaphore.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACING_USE_TSC 1
+#else
+#define TRACING_USE_TSC 0
+#endif
+
 #include "tracing.h"
 
+/* How often the flusher thread wakes up on its own, in milliseconds. It is
+ * also woken up early by any processor whose ring becomes half full. */
+#define TRACING_FLUSH_PERIOD_MS 10
+
+bool TracingEnabled = false;
+
+/* All open contexts, and the lock protecting the list and all flushes. Only
+ * the flusher thread and context creation/destruction take this lock. */
+static pthread_mutex_t TracingLock = PTHREAD_MUTEX_INITIALIZER;
+static struct TracingContext *TracingContexts = NULL;
+static bool TracingFlusherStarted = false;
+static sem_t TracingFlusherWakeup;
+
+/* Conversion from cycle counts to nanoseconds on the same clock that the
+ * traces used to be stamped with, so that timestamps stay comparable. */
+static struct {
+  uint64_t baseCycles;
+  uint64_t baseNanos;
+  double nanosPerCycle;
+} TracingClock;
+
+static inline void
+TracingGetTimespec(struct timespec *ts)
+{
+#if defined(__APPLE__)
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  ts->tv_sec = tv.tv_sec;
+  ts->tv_nsec = 1000 * tv.tv_usec;
+#elif defined(CLOCK_MONOTONIC_RAW)
+  clock_gettime(CLOCK_MONOTONIC_RAW, ts);
+#else
+  clock_gettime(CLOCK_MONOTONIC, ts);
+#endif
+}
+
+static inline uint64_t TracingGetNanos(void) {
+  struct timespec ts;
+  TracingGetTimespec(&ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t TracingReadCycles(void) {
+#if TRACING_USE_TSC
+  return __rdtsc();
+#else
+  return TracingGetNanos();
+#endif
+}
+
+/* Measure the TSC frequency against the clock over a short interval. This
+ * assumes an invariant TSC, which every x86 processor of the last decade
+ * has. */
+static void TracingCalibrateClock(void) {
+#if TRACING_USE_TSC
+  struct timespec delay = { .tv_sec = 0, .tv_nsec = 10 * 1000 * 1000 };
+  uint64_t c0, c1, t0, t1;
+
+  t0 = TracingGetNanos();
+  c0 = TracingReadCycles();
+  nanosleep(&delay, NULL);
+  t1 = TracingGetNanos();
+  c1 = TracingReadCycles();
+
+  TracingClock.baseCycles = c0;
+  TracingClock.baseNanos = t0;
+  TracingClock.nanosPerCycle =
+    (c1 > c0) ? (double)(t1 - t0) / (double)(c1 - c0) : 1.0;
+#else
+  TracingClock.baseCycles = 0;
+  TracingClock.baseNanos = 0;
+  TracingClock.nanosPerCycle = 1.0;
+#endif
+}
+
+static void *TracingFlusherLoop(__attribute__ ((unused)) void *arg) {
+  while (true) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += TRACING_FLUSH_PERIOD_MS * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&TracingFlusherWakeup, &deadline) == -1
+           && errno == EINTR)
+      ;
+
+    TracingFlushAll();
+  }
+  return NULL;
+}
+
+/* Must hold TracingLock. */
+static void TracingStartFlusher(void) {
+  pthread_t flusher;
+
+  if (TracingFlusherStarted)
+    return;
+
+  TracingCalibrateClock();
+
+  if (sem_init(&TracingFlusherWakeup, 0, 0) != 0) {
+    fprintf(stderr, "Tracing: could not create flusher semaphore\n");
+    exit(1);
+  }
+
+  if (pthread_create(&flusher, NULL, TracingFlusherLoop, NULL) != 0) {
+    fprintf(stderr, "Tracing: could not start flusher thread\n");
+    exit(1);
+  }
+  pthread_detach(flusher);
+
+  TracingFlusherStarted = true;
+}
+
 struct TracingContext *TracingNewContext(const char *filename,
                                          size_t bufferCapacity,
                                          uint32_t procNumber) {
   struct TracingContext *ctx;
+  size_t capacity;
+
+  /* round up to a power of two, so that indexing the ring is a mask */
+  for (capacity = 2; capacity < bufferCapacity; capacity *= 2)
+    ;
 
   if ((ctx = malloc(sizeof *ctx)) == NULL) {
     fprintf(stderr, "Tracing: could not allocate context\n");
     exit(1);
   }
 
-  if ((ctx->buffer = calloc(bufferCapacity, sizeof *ctx->buffer)) == NULL) {
+  if ((ctx->buffer = calloc(capacity, sizeof *ctx->buffer)) == NULL) {
     fprintf(stderr, "Tracing: could not allocate buffer\n");
     exit(1);
   }
@@ -34,8 +165,16 @@ struct TracingContext *TracingNewContext(const char *filename,
   }
 
   ctx->id = procNumber;
-  ctx->capacity = bufferCapacity;
-  ctx->index = 0;
+  ctx->capacity = capacity;
+  ctx->head = 0;
+  ctx->tail = 0;
+  ctx->dropped = 0;
+
+  pthread_mutex_lock(&TracingLock);
+  TracingStartFlusher();
+  ctx->next = TracingContexts;
+  TracingContexts = ctx;
+  pthread_mutex_unlock(&TracingLock);
 
   Trace_(ctx, EVENT_INIT, 0, 0, 0);
 
@@ -46,10 +185,21 @@ void TracingCloseAndFreeContext(struct TracingContext **ctx) {
   if (*ctx == NULL)
     return;
 
-  /* Mark termination in the log file. */
-  Trace_(*ctx, EVENT_FINISH, 0, 0, 0);
+  /* Mark termination in the log file, along with the number of events that
+   * were lost because the ring was full. */
+  Trace_(*ctx, EVENT_FINISH, (*ctx)->dropped, 0, 0);
 
+  pthread_mutex_lock(&TracingLock);
   TracingFlushBuffer(*ctx);
+  for (struct TracingContext **cursor = &TracingContexts;
+       *cursor != NULL;
+       cursor = &((*cursor)->next)) {
+    if (*cursor == *ctx) {
+      *cursor = (*ctx)->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&TracingLock);
 
   fclose((*ctx)->file);
   free((*ctx)->buffer);
@@ -57,35 +207,47 @@ void TracingCloseAndFreeContext(struct TracingContext **ctx) {
   *ctx = NULL;
 }
 
+/* Must hold TracingLock (this is the only consumer of the ring). */
 void TracingFlushBuffer(struct TracingContext *ctx) {
   assert(ctx);
   assert(ctx->file);
-  assert(ctx->index <= ctx->capacity);
 
-  size_t nitems = ctx->index;
+  size_t tail = ctx->tail;
+  size_t head = __atomic_load_n(&ctx->head, __ATOMIC_ACQUIRE);
+  assert(head - tail <= ctx->capacity);
 
-  if (fwrite(ctx->buffer, sizeof *ctx->buffer, nitems, ctx->file) < nitems) {
-    fprintf(stderr, "Tracing: could not write to file\n");
-    exit(1);
+  while (tail != head) {
+    size_t start = tail & (ctx->capacity - 1);
+    size_t nitems = head - tail;
+    /* don't run off the end of the ring; the rest is written next round */
+    if (start + nitems > ctx->capacity)
+      nitems = ctx->capacity - start;
+
+    if (fwrite(&ctx->buffer[start], sizeof *ctx->buffer, nitems, ctx->file)
+        < nitems) {
+      fprintf(stderr, "Tracing: could not write to file\n");
+      exit(1);
+    }
+
+    tail += nitems;
   }
 
-  ctx->index = 0;
+  fflush(ctx->file);
+  __atomic_store_n(&ctx->tail, tail, __ATOMIC_RELEASE);
 }
 
-static inline void
-TracingGetTimespec(struct timespec *ts)
-{
-#if defined(__APPLE__)
-  struct timeval tv;
+void TracingFlushAll(void) {
+  pthread_mutex_lock(&TracingLock);
+  for (struct TracingContext *ctx = TracingContexts;
+       ctx != NULL;
+       ctx = ctx->next) {
+    TracingFlushBuffer(ctx);
+  }
+  pthread_mutex_unlock(&TracingLock);
+}
 
-  gettimeofday(&tv, NULL);
-  ts->tv_sec = tv.tv_sec;
-  ts->tv_nsec = 1000 * tv.tv_usec;
-#elif defined(CLOCK_MONOTONIC_RAW)
-  clock_gettime(CLOCK_MONOTONIC_RAW, ts);
-#else
-  clock_gettime(CLOCK_MONOTONIC, ts);
-#endif
+void TracingSetEnabled(bool enabled) {
+  __atomic_store_n(&TracingEnabled, enabled, __ATOMIC_RELAXED);
 }
 
 void Trace_(struct TracingContext *ctx, int kind,
@@ -93,17 +255,30 @@ void Trace_(struct TracingContext *ctx, int kind,
   if (!ctx)
     return;
 
-  assert(ctx->index < ctx->capacity);
+  size_t head = ctx->head;
+  size_t tail = __atomic_load_n(&ctx->tail, __ATOMIC_ACQUIRE);
 
-  struct Event ev;
-  ev.kind = kind;
-  ev.argptr = ctx->id;
-  TracingGetTimespec(&ev.ts);
-  ev.arg1 = arg1;
-  ev.arg2 = arg2;
-  ev.arg3 = arg3;
+  if (head - tail >= ctx->capacity) {
+    ctx->dropped++;
+    return;
+  }
 
-  ctx->buffer[ctx->index++] = ev;
-  if (ctx->index == ctx->capacity)
-    TracingFlushBuffer(ctx);
+  uint64_t nanos = TracingClock.baseNanos + (uint64_t)
+    ((double)(TracingReadCycles() - TracingClock.baseCycles)
+     * TracingClock.nanosPerCycle);
+
+  struct Event *ev = &ctx->buffer[head & (ctx->capacity - 1)];
+  ev->kind = kind;
+  ev->argptr = ctx->id;
+  ev->ts.tv_sec = nanos / 1000000000ULL;
+  ev->ts.tv_nsec = nanos % 1000000000ULL;
+  ev->arg1 = arg1;
+  ev->arg2 = arg2;
+  ev->arg3 = arg3;
+
+  __atomic_store_n(&ctx->head, head + 1, __ATOMIC_RELEASE);
+
+  /* wake the flusher early, once per fill, rather than waiting for it */
+  if (head + 1 - tail == ctx->capacity / 2)
+    sem_post(&TracingFlusherWakeup);
 }
@@ -7,22 +7,36 @@
 #ifndef TRACING_H
 #define TRACING_H
 
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "trace.h"
 
 /* A structure holding the information required to record tracing
- * messages. Messages are buffered into memory and periodically flushed to disk
- * when the buffer is full. */
+ * messages. Each processor has its own context, with a fixed-size ring buffer
+ * of events. The processor is the only producer, and a background flusher
+ * thread is the only consumer, so recording an event never takes a lock or
+ * does any I/O. If the ring fills up before the flusher gets to it, new
+ * events are dropped (and counted) rather than stalling the processor. */
 struct TracingContext {
   struct Event *buffer;
   size_t id;
-  size_t index;
-  size_t capacity;
+  size_t capacity;      /* always a power of two */
+  size_t head;          /* next slot to fill; written only by the producer */
+  size_t tail;          /* next slot to flush; written only by the flusher */
+  size_t dropped;
   FILE *file;
+  struct TracingContext *next;
 };
 
-/* Allocates a new tracing context and open its backing file. */
+/* Whether events are currently being recorded. Every Trace() checks this
+ * first, so a disabled trace point costs a single predictable branch. */
+extern bool TracingEnabled;
+
+/* Allocates a new tracing context and open its backing file. The first
+ * context also starts the background flusher thread. */
 struct TracingContext *TracingNewContext(const char *filename,
                                          size_t bufferCapacity,
                                          uint32_t procNumber);
@@ -31,26 +45,32 @@ struct TracingContext *TracingNewContext(const char *filename,
  * flushed. */
 void TracingCloseAndFreeContext(struct TracingContext **ctx);
 
-/* Flush recent events to the backing file. This function is automatically
- * called by Trace() when the trace buffer is full, so there should be no need
- * to call it manually. */
+/* Flush recent events to the backing file. This is normally done by the
+ * flusher thread, so there should be no need to call it manually. */
 void TracingFlushBuffer(struct TracingContext *ctx);
 
+/* Flush the buffers of every open context, e.g. right before exiting. */
+void TracingFlushAll(void);
+
+/* Turn recording on or off for all processors. */
+void TracingSetEnabled(bool enabled);
+
 /* Add a new log event to the tracing context. */
 void Trace_(struct TracingContext *ctx, int kind,
             EventInt arg1, EventInt arg2, EventInt arg3);
 
-#ifdef ENABLE_TRACING
-#define Trace(...) Trace_((s)->trace, __VA_ARGS__)
+#define Trace(...)                                      \
+  do {                                                  \
+    if (__builtin_expect(TracingEnabled, 0))            \
+      Trace_((s)->trace, __VA_ARGS__);                  \
+  } while (0)
 #define WITH_GCSTATE(code)                              \
   do {                                                  \
-    GC_state s = pthread_getspecific(gcstate_key);      \
-    code;                                               \
-  } while (0);
-#else
-#define Trace(...) ((void)0)
-#define WITH_GCSTATE(code) ((void)0)
-#endif
+    if (__builtin_expect(TracingEnabled, 0)) {          \
+      GC_state s = pthread_getspecific(gcstate_key);    \
+      code;                                             \
+    }                                                   \
+  } while (0)
 
 #define Trace0(k)               Trace(k,  0,  0,  0)
 #define Trace1(k, a0)           Trace(k, a0,  0,  0)
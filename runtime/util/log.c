@@ -43,21 +43,26 @@ void L_setFile(FILE* file) {
   logFile = file;
 }
 
-bool L_levelEnabled(enum LogLevel messageLevel, enum LogLevel logLevel) {
-  return (messageLevel <= logLevel);
-}
-
 void L_log(bool flush,
            enum LogLevel level,
            size_t processor,
            const char* function,
            const char* format,
            ...) {
-  char formattedMessage[L_MAX_MESSAGE_LENGTH];
   va_list substitutions;
   va_start(substitutions, format);
-  vsnprintf(formattedMessage, sizeof(formattedMessage), format, substitutions);
+  L_vlog(flush, level, processor, function, format, substitutions);
   va_end(substitutions);
+}
+
+void L_vlog(bool flush,
+            enum LogLevel level,
+            size_t processor,
+            const char* function,
+            const char* format,
+            va_list substitutions) {
+  char formattedMessage[L_MAX_MESSAGE_LENGTH];
+  vsnprintf(formattedMessage, sizeof(formattedMessage), format, substitutions);
 
   fprintf(logFile,
           "%-*s [P%02zd|%s]: %s\n",
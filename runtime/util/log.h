@@ -15,6 +15,7 @@
 #ifndef LOG_H_
 #define LOG_H_
 
+#include <stdarg.h>
 #include <stdio.h>
 
 enum LogLevel {
@@ -47,7 +48,10 @@ void L_setFile(FILE* file);
  * @return TRUE if this message's level is enabled according to 'logLevel',
  * FALSE otherwise
  */
-bool L_levelEnabled(enum LogLevel messageLevel, enum LogLevel logLevel);
+static inline bool L_levelEnabled(enum LogLevel messageLevel,
+                                  enum LogLevel logLevel) {
+  return (messageLevel <= logLevel);
+}
 
 /**
  * This function creates a log message
@@ -71,4 +75,15 @@ void L_log(bool flush,
            ...)
     __attribute__((format (printf, 5, 6)));
 
+/**
+ * Like L_log(), but with the format arguments in a va_list.
+ */
+void L_vlog(bool flush,
+            enum LogLevel level,
+            size_t processor,
+            const char* function,
+            const char* format,
+            va_list substitutions)
+    __attribute__((format (printf, 5, 0)));
+
 #endif /* LOGGER_H_ */